@@ -32,5 +32,6 @@
 # include "Locker/demo.h"
 # include "Locker/locker.h"
 # include "Locker/plugin.h"
+# include "Locker/status.h"
 
 #endif /* !DESKTOP_LOCKER_H */
@@ -46,6 +46,14 @@ typedef struct _LockerAuthHelper
 			char const * variable);
 	int (*config_set)(Locker * locker, char const * section,
 			char const * variable, char const * value);
+	/* resolve a section once, then look its variables up repeatedly */
+	LockerConfigSection * (*config_section)(Locker * locker,
+			char const * section);
+	char const * (*config_section_get)(Locker * locker,
+			LockerConfigSection const * section,
+			char const * variable);
+	/* report a failed authentication attempt */
+	void (*failed)(Locker * locker);
 } LockerAuthHelper;
 
 typedef const struct _LockerAuthDefinition
@@ -37,6 +37,9 @@
 /* types */
 typedef struct _LockerDemo LockerDemo;
 
+/* called with the frame time (in microseconds), return FALSE to stop */
+typedef gboolean (*LockerDemoFrameFunc)(gint64 time, gpointer data);
+
 typedef struct _LockerDemoHelper
 {
 	Locker * locker;
@@ -45,6 +48,30 @@ typedef struct _LockerDemoHelper
 			char const * variable);
 	int (*config_set)(Locker * locker, char const * section,
 			char const * variable, char const * value);
+	/* resolve a section once, then look its variables up repeatedly */
+	LockerConfigSection * (*config_section)(Locker * locker,
+			char const * section);
+	char const * (*config_section_get)(Locker * locker,
+			LockerConfigSection const * section,
+			char const * variable);
+	/* call func once per frame presented, at most fps times per second
+	 * (or on every frame if 0) */
+	guint (*frame_add)(Locker * locker, unsigned int fps,
+			LockerDemoFrameFunc func, gpointer data);
+	void (*frame_remove)(Locker * locker, guint id);
+	/* time elapsed since the demo was started (in microseconds) */
+	gint64 (*frame_elapsed)(Locker * locker);
+	/* monotonic time by which the current frame should be rendered */
+	gint64 (*frame_deadline)(Locker * locker);
+	/* report an area of the buffer changed by render(), to present only
+	 * these; the whole area rendered is presented if none is reported,
+	 * an empty area means nothing changed, and only the parts within the
+	 * area rendered are considered */
+	void (*frame_damage)(Locker * locker, GdkRectangle const * area);
+	/* how many frames ago the buffer given to render() was last rendered
+	 * into for the same monitor: 1 if it holds the previous frame, or 0 if
+	 * its contents are undefined (e.g. once allocated again) */
+	int (*frame_age)(Locker * locker);
 } LockerDemoHelper;
 
 typedef const struct _LockerDemoDefinition
@@ -60,6 +87,16 @@ typedef const struct _LockerDemoDefinition
 	void (*start)(LockerDemo * demo);
 	void (*stop)(LockerDemo * demo);
 	void (*cycle)(LockerDemo * demo);
+	/* render into a buffer owned by the host, as CAIRO_FORMAT_ARGB32 */
+	/* rect is the monitor, clip the area to render within the buffer */
+	/* time elapsed since the demo was started (in microseconds) */
+	/* returns -1 on errors, or for how long the frame is the same (ms) */
+	/* may run concurrently, so only modify the buffer within clip */
+	/* may be presented on every monitor of the same size as rect */
+	/* buffer holds the previous frame only if frame_age() returns 1 */
+	int (*render)(LockerDemo * demo, unsigned char * buffer, int stride,
+			GdkRectangle const * rect, GdkRectangle const * clip,
+			gint64 time);
 } LockerDemoDefinition;
 
 #endif /* !DESKTOP_LOCKER_DEMO_H */
@@ -34,6 +34,8 @@
 /* types */
 typedef struct _Locker Locker;
 
+typedef struct _LockerConfigSection LockerConfigSection;
+
 typedef enum _LockerAction
 {
 	LOCKER_ACTION_ACTIVATE = 0,
@@ -49,12 +51,14 @@ typedef enum _LockerAction
 	LOCKER_ACTION_SUSPEND,
 	LOCKER_ACTION_UNLOCK
 } LockerAction;
+# define LOCKER_ACTION_LAST	LOCKER_ACTION_UNLOCK
+# define LOCKER_ACTION_COUNT	(LOCKER_ACTION_LAST + 1)
 
 typedef enum _LockerEvent
 {
 	LOCKER_EVENT_ACTIVATING = 0,
 	LOCKER_EVENT_ACTIVATED,
-	LOCKER_EVENT_CYCLING = 0,
+	LOCKER_EVENT_CYCLING,
 	LOCKER_EVENT_CYCLED,
 	LOCKER_EVENT_DEACTIVATING,
 	LOCKER_EVENT_DEACTIVATED,
@@ -62,8 +66,14 @@ typedef enum _LockerEvent
 	LOCKER_EVENT_LOCKED,
 	LOCKER_EVENT_SUSPENDING,
 	LOCKER_EVENT_UNLOCKING,
-	LOCKER_EVENT_UNLOCKED
+	LOCKER_EVENT_UNLOCKED,
+	LOCKER_EVENT_AUTH_FAILED
 } LockerEvent;
+# define LOCKER_EVENT_LAST	LOCKER_EVENT_AUTH_FAILED
+# define LOCKER_EVENT_COUNT	(LOCKER_EVENT_LAST + 1)
+
+# define LOCKER_EVENT_MASK(event)	(1 << (event))
+# define LOCKER_EVENT_MASK_ALL		((1 << LOCKER_EVENT_COUNT) - 1)
 
 
 /* constants */
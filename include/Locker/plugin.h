@@ -48,6 +48,12 @@ typedef struct _LockerPluginHelper
 			char const * variable);
 	int (*config_set)(Locker * locker, char const * section,
 			char const * variable, char const * value);
+	/* resolve a section once, then look its variables up repeatedly */
+	LockerConfigSection * (*config_section)(Locker * locker,
+			char const * section);
+	char const * (*config_section_get)(Locker * locker,
+			LockerConfigSection const * section,
+			char const * variable);
 } LockerPluginHelper;
 
 struct _LockerPluginDefinition
@@ -58,6 +64,14 @@ struct _LockerPluginDefinition
 	LockerPlugin * (*init)(LockerPluginHelper * helper);
 	void (*destroy)(LockerPlugin * plugin);
 	int (*event)(LockerPlugin * plugin, LockerEvent event);
+	/* events handled, as a LOCKER_EVENT_MASK() combination (0 for all) */
+	unsigned int events;
+	unsigned int flags;
 };
 
+
+/* constants */
+/* only initialize when one of the events handled first occurs */
+# define LOCKER_PLUGIN_FLAG_ON_DEMAND	0x1
+
 #endif /* !DESKTOP_LOCKER_PLUGIN_H */
@@ -0,0 +1,67 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#ifndef DESKTOP_LOCKER_STATUS_H
+# define DESKTOP_LOCKER_STATUS_H
+
+# include <stdint.h>
+
+
+/* LockerStatus */
+/* public */
+/* types */
+/* the status page is updated with a sequence lock: readers copy it while the
+ * sequence is even and unchanged from before to after the copy, and try
+ * again otherwise. All values are in host byte order. */
+typedef struct _LockerStatus
+{
+	uint32_t magic;
+	uint32_t version;
+	/* odd while being updated */
+	volatile uint32_t sequence;
+	uint32_t flags;
+	/* monotonic time of the last lock (in microseconds) */
+	int64_t locked;
+	/* failed attempts since the last lock */
+	uint32_t failed;
+	uint32_t pid;
+	/* name of the current demo, if any */
+	char demo[64];
+} LockerStatus;
+
+
+/* constants */
+# define LOCKER_STATUS_MAGIC	0x4c4f434b
+# define LOCKER_STATUS_VERSION	1
+
+/* appended to the path of the control socket */
+# define LOCKER_STATUS_SUFFIX	".status"
+
+# define LOCKER_STATUS_FLAG_ACTIVE	0x1
+# define LOCKER_STATUS_FLAG_LOCKED	0x2
+
+#endif /* !DESKTOP_LOCKER_STATUS_H */
@@ -281,6 +281,7 @@ static void _password_on_password_activate(gpointer data)
 		}
 	}
 	gtk_entry_set_text(GTK_ENTRY(password->password), "");
+	helper->failed(helper->locker);
 	helper->error(NULL, _("Authentication failed"), 1);
 	gtk_widget_grab_focus(password->password);
 	gtk_label_set_text(GTK_LABEL(password->error), _("Wrong password!"));
@@ -0,0 +1,159 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "control.h"
+
+
+/* LockerControl */
+/* private */
+/* prototypes */
+static char const * _locker_control_runtime(char * buf, size_t size);
+
+
+/* public */
+/* functions */
+/* locker_control_path */
+char * locker_control_path(char const * display)
+{
+	char * ret;
+	char const * runtime;
+	char buf[32];
+	struct sockaddr_un sa;
+	size_t len;
+	char * p;
+
+	if(display == NULL && (display = getenv("DISPLAY")) == NULL)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+	/* the runtime directory is private to the user */
+	if((runtime = getenv("XDG_RUNTIME_DIR")) == NULL || runtime[0] != '/')
+		if((runtime = _locker_control_runtime(buf, sizeof(buf)))
+				== NULL)
+			return NULL;
+	len = strlen(runtime) + sizeof("/" LOCKER_CONTROL_SOCKET)
+		+ strlen(display);
+	if(len > sizeof(sa.sun_path))
+	{
+		errno = ENAMETOOLONG;
+		return NULL;
+	}
+	if((ret = malloc(len)) == NULL)
+		return NULL;
+	snprintf(ret, len, "%s/%s%s", runtime, LOCKER_CONTROL_SOCKET, display);
+	/* ignore the screen number */
+	p = &ret[strlen(runtime) + 1];
+	if((p = strrchr(p, ':')) != NULL && (p = strchr(p, '.')) != NULL)
+		*p = '\0';
+	/* do not create sub-directories */
+	for(p = &ret[strlen(runtime) + 1]; *p != '\0'; p++)
+		if(*p == '/')
+			*p = '_';
+	return ret;
+}
+
+
+/* useful */
+/* locker_control_read */
+int locker_control_read(int fd, void * buf, size_t size)
+{
+	char * p = buf;
+	ssize_t s;
+
+	while(size > 0)
+		if((s = read(fd, p, size)) > 0)
+		{
+			p += s;
+			size -= s;
+		}
+		else if(s == 0)
+		{
+			errno = ECONNRESET;
+			return -1;
+		}
+		else if(errno != EINTR)
+			return -1;
+	return 0;
+}
+
+
+/* locker_control_write */
+int locker_control_write(int fd, void const * buf, size_t size)
+{
+	char const * p = buf;
+	ssize_t s;
+
+	while(size > 0)
+#ifdef MSG_NOSIGNAL
+		/* do not get killed if the peer went away */
+		if((s = send(fd, p, size, MSG_NOSIGNAL)) >= 0)
+#else
+		if((s = write(fd, p, size)) >= 0)
+#endif
+		{
+			p += s;
+			size -= s;
+		}
+		else if(errno != EINTR)
+			return -1;
+	return 0;
+}
+
+
+/* private */
+/* functions */
+/* locker_control_runtime */
+static char const * _locker_control_runtime(char * buf, size_t size)
+{
+	uid_t uid = getuid();
+	struct stat st;
+
+	/* fallback to a directory of our own in /tmp */
+	snprintf(buf, size, "%s%lu", "/tmp/" LOCKER_CONTROL_SOCKET "-",
+			(unsigned long)uid);
+	if(mkdir(buf, 0700) != 0 && errno != EEXIST)
+		return NULL;
+	/* which must not have been created by anyone else */
+	if(lstat(buf, &st) != 0)
+		return NULL;
+	if(!S_ISDIR(st.st_mode) || st.st_uid != uid
+			|| (st.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+	{
+		errno = EPERM;
+		return NULL;
+	}
+	return buf;
+}
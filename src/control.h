@@ -0,0 +1,79 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#ifndef LOCKER_CONTROL_H
+# define LOCKER_CONTROL_H
+
+# include <sys/types.h>
+# include <stdint.h>
+
+
+/* LockerControl */
+/* types */
+typedef enum _LockerControlCommand
+{
+	LOCKER_CONTROL_ACTION = 0,
+	LOCKER_CONTROL_LATENCY,
+	LOCKER_CONTROL_SUBSCRIBE
+} LockerControlCommand;
+# define LOCKER_CONTROL_LAST	LOCKER_CONTROL_SUBSCRIBE
+# define LOCKER_CONTROL_COUNT	(LOCKER_CONTROL_LAST + 1)
+
+typedef enum _LockerControlStatus
+{
+	LOCKER_CONTROL_STATUS_OK = 0,
+	LOCKER_CONTROL_STATUS_ERROR,
+	LOCKER_CONTROL_STATUS_INVALID
+} LockerControlStatus;
+
+/* requests and replies share the same header, in host byte order */
+typedef struct _LockerControlMessage
+{
+	uint32_t id;		/* copied from the request into the reply */
+	uint16_t command;	/* LockerControlCommand */
+	uint16_t action;	/* LockerAction, for LOCKER_CONTROL_ACTION */
+	uint16_t flags;
+	uint16_t status;	/* LockerControlStatus, in replies */
+	uint32_t length;	/* of the data following the header */
+} LockerControlMessage;
+
+
+/* constants */
+# define LOCKER_CONTROL_SOCKET	"Locker"
+
+/* reply to LOCKER_ACTION_LOCK only once the screen is locked */
+# define LOCKER_CONTROL_FLAG_WAIT	0x1
+
+
+/* functions */
+char * locker_control_path(char const * display);
+
+/* useful */
+int locker_control_read(int fd, void * buf, size_t size);
+int locker_control_write(int fd, void const * buf, size_t size);
+
+#endif /* !LOCKER_CONTROL_H */
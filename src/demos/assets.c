@@ -0,0 +1,204 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#ifdef __GLIBC__
+# include <malloc.h>
+#endif
+#include <System.h>
+#include "assets.h"
+
+/* constants */
+/* interval between two checks of the memory pressure (in seconds) */
+#define ASSETS_POLL	10
+#define ASSETS_PRESSURE	"/proc/pressure/memory"
+
+
+/* Assets */
+/* private */
+/* types */
+struct _Assets
+{
+	LockerDemo * demo;
+	AssetsLoad load;
+	AssetsUnload unload;
+
+	/* settings */
+	unsigned int idle;
+	unsigned int pressure;
+
+	/* state */
+	gboolean loaded;
+	gint64 released;
+	guint source;
+};
+
+
+/* prototypes */
+static void _assets_evict(Assets * assets);
+static gboolean _assets_pressure(Assets * assets);
+
+/* callbacks */
+static gboolean _assets_on_timeout(gpointer data);
+
+
+/* public */
+/* functions */
+/* assets_new */
+Assets * assets_new(LockerDemo * demo, AssetsLoad load, AssetsUnload unload)
+{
+	Assets * assets;
+
+	if((assets = object_new(sizeof(*assets))) == NULL)
+		return NULL;
+	assets->demo = demo;
+	assets->load = load;
+	assets->unload = unload;
+	assets->idle = 0;
+	assets->pressure = 0;
+	assets->loaded = FALSE;
+	assets->released = 0;
+	assets->source = 0;
+	return assets;
+}
+
+
+/* assets_delete */
+void assets_delete(Assets * assets)
+{
+	if(assets->source != 0)
+		g_source_remove(assets->source);
+	if(assets->loaded)
+		assets->unload(assets->demo);
+	object_delete(assets);
+}
+
+
+/* assets_configure */
+void assets_configure(Assets * assets, LockerDemoHelper * helper,
+		LockerConfigSection const * config)
+{
+	char const * p;
+	long l;
+
+	assets->idle = 0;
+	if((p = helper->config_section_get(helper->locker, config,
+					"assets_idle")) != NULL
+			&& (l = strtol(p, NULL, 10)) > 0)
+		assets->idle = l;
+	assets->pressure = 0;
+	if((p = helper->config_section_get(helper->locker, config,
+					"assets_pressure")) != NULL
+			&& (l = strtol(p, NULL, 10)) > 0 && l <= 100)
+		assets->pressure = l;
+}
+
+
+/* useful */
+/* assets_acquire */
+int assets_acquire(Assets * assets)
+{
+	if(assets->source != 0)
+		g_source_remove(assets->source);
+	assets->source = 0;
+	if(assets->loaded)
+		return 0;
+	/* do not try again until evicted, even if some are missing */
+	assets->loaded = TRUE;
+	return assets->load(assets->demo);
+}
+
+
+/* assets_release */
+void assets_release(Assets * assets)
+{
+	guint interval = assets->idle;
+
+	if(!assets->loaded || assets->source != 0
+			|| (assets->idle == 0 && assets->pressure == 0))
+		return;
+	assets->released = g_get_monotonic_time();
+	/* check the memory pressure regularly meanwhile */
+	if(assets->pressure != 0 && (interval == 0 || interval > ASSETS_POLL))
+		interval = ASSETS_POLL;
+	assets->source = g_timeout_add_seconds(interval, _assets_on_timeout,
+			assets);
+}
+
+
+/* private */
+/* functions */
+/* assets_evict */
+static void _assets_evict(Assets * assets)
+{
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	assets->unload(assets->demo);
+	assets->loaded = FALSE;
+#ifdef __GLIBC__
+	/* return the memory of the images decoded to the system */
+	malloc_trim(0);
+#endif
+}
+
+
+/* assets_pressure */
+static gboolean _assets_pressure(Assets * assets)
+{
+	FILE * fp;
+	double avg10;
+	int res;
+
+	/* the share of time some tasks stalled on memory, with Linux PSI */
+	if((fp = fopen(ASSETS_PRESSURE, "r")) == NULL)
+		return FALSE;
+	res = fscanf(fp, "some avg10=%lf", &avg10);
+	fclose(fp);
+	return (res == 1 && avg10 >= assets->pressure) ? TRUE : FALSE;
+}
+
+
+/* callbacks */
+/* assets_on_timeout */
+static gboolean _assets_on_timeout(gpointer data)
+{
+	Assets * assets = data;
+	gint64 idle;
+
+	idle = (g_get_monotonic_time() - assets->released) / G_USEC_PER_SEC;
+	if((assets->idle != 0 && idle >= assets->idle)
+			|| (assets->pressure != 0 && _assets_pressure(assets)))
+	{
+		assets->source = 0;
+		_assets_evict(assets);
+		return FALSE;
+	}
+	return TRUE;
+}
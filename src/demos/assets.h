@@ -0,0 +1,60 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#ifndef LOCKER_DEMOS_ASSETS_H
+# define LOCKER_DEMOS_ASSETS_H
+
+# include "Locker/demo.h"
+
+
+/* Assets */
+/* types */
+typedef struct _Assets Assets;
+
+/* decode the assets of the demo, return non-zero if some are missing */
+typedef int (*AssetsLoad)(LockerDemo * demo);
+/* release every asset of the demo */
+typedef void (*AssetsUnload)(LockerDemo * demo);
+
+
+/* functions */
+/* decode the assets of a demo only while they are used */
+Assets * assets_new(LockerDemo * demo, AssetsLoad load, AssetsUnload unload);
+void assets_delete(Assets * assets);
+
+/* evict the assets after assets_idle seconds stopped, or as soon as the
+ * memory pressure reaches assets_pressure percent (0 to disable either) */
+void assets_configure(Assets * assets, LockerDemoHelper * helper,
+		LockerConfigSection const * config);
+
+/* useful */
+/* load the assets if necessary, when starting */
+int assets_acquire(Assets * assets);
+/* allow the assets to be evicted, when stopping */
+void assets_release(Assets * assets);
+
+#endif /* !LOCKER_DEMOS_ASSETS_H */
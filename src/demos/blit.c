@@ -0,0 +1,727 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#include <string.h>
+#include <math.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# include <emmintrin.h>
+# include <immintrin.h>
+# define BLIT_X86
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+# include <arm_neon.h>
+# define BLIT_NEON
+#endif
+#include "blit.h"
+
+
+/* Blit */
+/* private */
+/* types */
+typedef void (*BlitOverFunc)(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha);
+/* sample a row of the source from fx, every dx (in 16.16 fixed point) */
+typedef void (*BlitNearestFunc)(uint32_t * dst, uint32_t const * row,
+		int src_width, int32_t fx, int32_t dx, size_t width);
+typedef void (*BlitBilinearFunc)(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width);
+
+
+/* constants */
+/* pixels scaled at once before compositing */
+#define BLIT_CHUNK	256
+
+
+/* variables */
+static char const * _blit_name = NULL;
+static BlitOverFunc _blit_over = NULL;
+static BlitNearestFunc _blit_nearest = NULL;
+static BlitBilinearFunc _blit_bilinear = NULL;
+
+
+/* prototypes */
+static uint32_t _blit_lerp(uint32_t p, uint32_t q, unsigned int weight);
+static uint32_t _blit_mul(uint32_t p, unsigned int alpha);
+static unsigned int _blit_sample(int32_t fx, int src_width, int * sx,
+		int * sx1);
+
+/* kernels */
+static void _blit_bilinear_scalar(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width);
+static void _blit_nearest_scalar(uint32_t * dst, uint32_t const * row,
+		int src_width, int32_t fx, int32_t dx, size_t width);
+static void _blit_over_scalar(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha);
+#ifdef BLIT_X86
+static void _blit_bilinear_avx2(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width);
+static void _blit_nearest_avx2(uint32_t * dst, uint32_t const * row,
+		int src_width, int32_t fx, int32_t dx, size_t width);
+static void _blit_over_avx2(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha);
+static void _blit_bilinear_sse2(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width);
+static void _blit_over_sse2(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha);
+#endif
+#ifdef BLIT_NEON
+static void _blit_bilinear_neon(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width);
+static void _blit_over_neon(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha);
+#endif
+
+
+/* public */
+/* functions */
+/* blit_init */
+void blit_init(void)
+{
+	if(_blit_over != NULL)
+		return;
+#if defined(BLIT_X86)
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+	{
+		_blit_name = "avx2";
+		_blit_nearest = _blit_nearest_avx2;
+		_blit_bilinear = _blit_bilinear_avx2;
+		_blit_over = _blit_over_avx2;
+		return;
+	}
+	if(__builtin_cpu_supports("sse2"))
+	{
+		/* without gathering, sampling the nearest pixels does not
+		 * vectorise */
+		_blit_name = "sse2";
+		_blit_nearest = _blit_nearest_scalar;
+		_blit_bilinear = _blit_bilinear_sse2;
+		_blit_over = _blit_over_sse2;
+		return;
+	}
+#elif defined(BLIT_NEON)
+	_blit_name = "neon";
+	_blit_nearest = _blit_nearest_scalar;
+	_blit_bilinear = _blit_bilinear_neon;
+	_blit_over = _blit_over_neon;
+	return;
+#endif
+	_blit_name = "scalar";
+	_blit_nearest = _blit_nearest_scalar;
+	_blit_bilinear = _blit_bilinear_scalar;
+	_blit_over = _blit_over_scalar;
+}
+
+
+/* blit_get_name */
+char const * blit_get_name(void)
+{
+	blit_init();
+	return _blit_name;
+}
+
+
+/* rows */
+/* blit_copy */
+void blit_copy(uint32_t * dst, uint32_t const * src, size_t width)
+{
+	/* the C library already provides vectorised copies */
+	memcpy(dst, src, width * sizeof(*dst));
+}
+
+
+/* blit_over */
+void blit_over(uint32_t * dst, uint32_t const * src, size_t width,
+		unsigned int alpha)
+{
+	if(alpha == 0 || width == 0)
+		return;
+	blit_init();
+	_blit_over(dst, src, width, (alpha > 255) ? 255 : alpha);
+}
+
+
+/* images */
+/* blit_composite */
+void blit_composite(unsigned char * dst, int dst_stride, int dst_width,
+		int dst_height, unsigned char const * src, int src_stride,
+		int src_width, int src_height, int x, int y, double scale,
+		unsigned int alpha, BlitFilter filter)
+{
+	uint32_t tmp[BLIT_CHUNK];
+	int width;
+	int height;
+	int x0, x1, y0, y1;
+	int i, j;
+	int32_t d;
+	int32_t fx;
+	int32_t fy;
+	int sy;
+	size_t n;
+	uint32_t * p;
+	uint32_t const * row0;
+	uint32_t const * row1;
+
+	if(alpha == 0 || scale <= 0.0 || src_width <= 0 || src_height <= 0)
+		return;
+	blit_init();
+	alpha = (alpha > 255) ? 255 : alpha;
+	width = ceil(src_width * scale);
+	height = ceil(src_height * scale);
+	/* clip to the destination */
+	x0 = (x < 0) ? 0 : x;
+	y0 = (y < 0) ? 0 : y;
+	x1 = (x + width > dst_width) ? dst_width : x + width;
+	y1 = (y + height > dst_height) ? dst_height : y + height;
+	if(x0 >= x1 || y0 >= y1)
+		return;
+	/* step in the source for every pixel (in 16.16 fixed point) */
+	d = 65536.0 / scale;
+	for(j = y0; j < y1; j++)
+	{
+		p = (uint32_t *)(dst + (size_t)j * dst_stride) + x0;
+		if(scale == 1.0)
+		{
+			row0 = (uint32_t const *)(src + (size_t)(j - y)
+					* src_stride) + (x0 - x);
+			_blit_over(p, row0, x1 - x0, alpha);
+			continue;
+		}
+		/* sample at the center of the pixels */
+		fy = (j - y) * d + d / 2;
+		if(filter == BLIT_FILTER_BILINEAR)
+			fy -= 32768;
+		fy = (fy < 0) ? 0 : fy;
+		sy = fy >> 16;
+		sy = (sy >= src_height) ? src_height - 1 : sy;
+		row0 = (uint32_t const *)(src + (size_t)sy * src_stride);
+		row1 = (sy + 1 < src_height) ? (uint32_t const *)(
+				(unsigned char const *)row0 + src_stride)
+			: row0;
+		for(i = x0; i < x1; i += n, p += n)
+		{
+			n = (x1 - i > BLIT_CHUNK) ? BLIT_CHUNK : x1 - i;
+			fx = (i - x) * d + d / 2;
+			if(filter == BLIT_FILTER_BILINEAR)
+				_blit_bilinear(tmp, row0, row1,
+						(fy >> 8) & 0xff, src_width,
+						fx - 32768, d, n);
+			else
+				_blit_nearest(tmp, row0, src_width, fx, d, n);
+			_blit_over(p, tmp, n, alpha);
+		}
+	}
+}
+
+
+/* private */
+/* functions */
+/* blit_lerp */
+static uint32_t _blit_lerp(uint32_t p, uint32_t q, unsigned int weight)
+{
+	uint32_t rb;
+	uint32_t ag;
+
+	/* weight goes from 0 (p) to 256 (q) */
+	rb = ((p & 0x00ff00ff) * (256 - weight)
+			+ (q & 0x00ff00ff) * weight) >> 8;
+	ag = ((p >> 8) & 0x00ff00ff) * (256 - weight)
+		+ ((q >> 8) & 0x00ff00ff) * weight;
+	return (rb & 0x00ff00ff) | (ag & 0xff00ff00);
+}
+
+
+/* blit_mul */
+static uint32_t _blit_mul(uint32_t p, unsigned int alpha)
+{
+	uint32_t rb;
+	uint32_t ag;
+
+	/* multiply every channel by alpha / 255, rounded */
+	rb = (p & 0x00ff00ff) * alpha + 0x00800080;
+	rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+	ag = ((p >> 8) & 0x00ff00ff) * alpha + 0x00800080;
+	ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+	return rb | ag;
+}
+
+
+/* blit_sample */
+static unsigned int _blit_sample(int32_t fx, int src_width, int * sx,
+		int * sx1)
+{
+	unsigned int wx;
+
+	/* the two pixels around fx, and the weight of the second one */
+	if(fx < 0)
+	{
+		*sx = 0;
+		wx = 0;
+	}
+	else
+	{
+		*sx = fx >> 16;
+		wx = (fx >> 8) & 0xff;
+	}
+	if(*sx >= src_width)
+		*sx = src_width - 1;
+	*sx1 = (*sx + 1 < src_width) ? *sx + 1 : *sx;
+	return wx;
+}
+
+
+/* kernels */
+/* blit_bilinear_scalar */
+static void _blit_bilinear_scalar(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width)
+{
+	size_t i;
+	int sx;
+	int sx1;
+	unsigned int wx;
+	uint32_t p;
+	uint32_t q;
+
+	for(i = 0; i < width; i++, fx += dx)
+	{
+		wx = _blit_sample(fx, src_width, &sx, &sx1);
+		p = _blit_lerp(row0[sx], row0[sx1], wx);
+		q = _blit_lerp(row1[sx], row1[sx1], wx);
+		dst[i] = _blit_lerp(p, q, wy);
+	}
+}
+
+
+/* blit_nearest_scalar */
+static void _blit_nearest_scalar(uint32_t * dst, uint32_t const * row,
+		int src_width, int32_t fx, int32_t dx, size_t width)
+{
+	size_t i;
+	int sx;
+
+	for(i = 0; i < width; i++, fx += dx)
+	{
+		sx = fx >> 16;
+		dst[i] = row[(sx >= src_width) ? src_width - 1 : sx];
+	}
+}
+
+
+/* blit_over_scalar */
+static void _blit_over_scalar(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha)
+{
+	size_t i;
+	uint32_t s;
+
+	for(i = 0; i < width; i++)
+	{
+		s = (alpha == 255) ? src[i] : _blit_mul(src[i], alpha);
+		dst[i] = s + _blit_mul(dst[i], 255 - (s >> 24));
+	}
+}
+
+
+#ifdef BLIT_X86
+/* blit_bilinear_avx2 */
+__attribute__((target("avx2")))
+static __m256i _bilinear_avx2_lerp(__m256i p, __m256i q, __m256i weight);
+
+__attribute__((target("avx2")))
+static void _blit_bilinear_avx2(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i mask = _mm256_set1_epi32(0xff);
+	const __m256i last = _mm256_set1_epi32(src_width - 1);
+	const __m256i step = _mm256_set1_epi32(dx * 8);
+	const __m256i y = _mm256_set1_epi16(wy);
+	size_t i;
+	__m256i f;
+	__m256i sx, sx1;
+	__m256i w, wlo, whi;
+	__m256i p0, p1, q0, q1;
+	__m256i plo, phi, qlo, qhi;
+
+	f = _mm256_add_epi32(_mm256_set1_epi32(fx), _mm256_mullo_epi32(
+				_mm256_set1_epi32(dx),
+				_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+	for(i = 0; i + 8 <= width; i += 8, f = _mm256_add_epi32(f, step))
+	{
+		/* as _blit_sample(), for 8 pixels at once */
+		sx = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(f,
+							16), zero), last);
+		sx1 = _mm256_min_epi32(_mm256_add_epi32(sx, one), last);
+		w = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, f),
+				_mm256_and_si256(_mm256_srli_epi32(f, 8),
+					mask));
+		p0 = _mm256_i32gather_epi32((int const *)row0, sx, 4);
+		p1 = _mm256_i32gather_epi32((int const *)row0, sx1, 4);
+		q0 = _mm256_i32gather_epi32((int const *)row1, sx, 4);
+		q1 = _mm256_i32gather_epi32((int const *)row1, sx1, 4);
+		/* the weight of every channel, as unpacked below */
+		w = _mm256_or_si256(w, _mm256_slli_epi32(w, 16));
+		wlo = _mm256_unpacklo_epi32(w, w);
+		whi = _mm256_unpackhi_epi32(w, w);
+		plo = _bilinear_avx2_lerp(_mm256_unpacklo_epi8(p0, zero),
+				_mm256_unpacklo_epi8(p1, zero), wlo);
+		phi = _bilinear_avx2_lerp(_mm256_unpackhi_epi8(p0, zero),
+				_mm256_unpackhi_epi8(p1, zero), whi);
+		qlo = _bilinear_avx2_lerp(_mm256_unpacklo_epi8(q0, zero),
+				_mm256_unpacklo_epi8(q1, zero), wlo);
+		qhi = _bilinear_avx2_lerp(_mm256_unpackhi_epi8(q0, zero),
+				_mm256_unpackhi_epi8(q1, zero), whi);
+		_mm256_storeu_si256((__m256i *)&dst[i], _mm256_packus_epi16(
+					_bilinear_avx2_lerp(plo, qlo, y),
+					_bilinear_avx2_lerp(phi, qhi, y)));
+	}
+	_blit_bilinear_scalar(&dst[i], row0, row1, wy, src_width,
+			fx + (int32_t)i * dx, dx, width - i);
+}
+
+__attribute__((target("avx2")))
+static __m256i _bilinear_avx2_lerp(__m256i p, __m256i q, __m256i weight)
+{
+	/* weight goes from 0 (p) to 256 (q), as with _blit_lerp() */
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(p,
+					_mm256_sub_epi16(_mm256_set1_epi16(256),
+						weight)),
+				_mm256_mullo_epi16(q, weight)), 8);
+}
+
+
+/* blit_nearest_avx2 */
+__attribute__((target("avx2")))
+static void _blit_nearest_avx2(uint32_t * dst, uint32_t const * row,
+		int src_width, int32_t fx, int32_t dx, size_t width)
+{
+	const __m256i last = _mm256_set1_epi32(src_width - 1);
+	const __m256i step = _mm256_set1_epi32(dx * 8);
+	size_t i;
+	__m256i f;
+	__m256i sx;
+
+	f = _mm256_add_epi32(_mm256_set1_epi32(fx), _mm256_mullo_epi32(
+				_mm256_set1_epi32(dx),
+				_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+	for(i = 0; i + 8 <= width; i += 8, f = _mm256_add_epi32(f, step))
+	{
+		sx = _mm256_min_epi32(_mm256_srai_epi32(f, 16), last);
+		_mm256_storeu_si256((__m256i *)&dst[i],
+				_mm256_i32gather_epi32((int const *)row, sx,
+					4));
+	}
+	_blit_nearest_scalar(&dst[i], row, src_width, fx + (int32_t)i * dx,
+			dx, width - i);
+}
+
+
+/* blit_over_avx2 */
+__attribute__((target("avx2")))
+static __m256i _over_avx2_div255(__m256i x);
+
+__attribute__((target("avx2")))
+static void _blit_over_avx2(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i mask = _mm256_set1_epi16(0xff);
+	const __m256i a = _mm256_set1_epi16(alpha);
+	size_t i;
+	__m256i s, d;
+	__m256i slo, shi, dlo, dhi;
+	__m256i ialo, iahi;
+
+	for(i = 0; i + 8 <= width; i += 8)
+	{
+		s = _mm256_loadu_si256((__m256i const *)&src[i]);
+		d = _mm256_loadu_si256((__m256i const *)&dst[i]);
+		slo = _mm256_unpacklo_epi8(s, zero);
+		shi = _mm256_unpackhi_epi8(s, zero);
+		if(alpha != 255)
+		{
+			slo = _over_avx2_div255(_mm256_mullo_epi16(slo, a));
+			shi = _over_avx2_div255(_mm256_mullo_epi16(shi, a));
+		}
+		/* broadcast the alpha channel of the source */
+		ialo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(slo,
+					_MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3));
+		iahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(shi,
+					_MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3));
+		ialo = _mm256_xor_si256(ialo, mask);
+		iahi = _mm256_xor_si256(iahi, mask);
+		dlo = _mm256_unpacklo_epi8(d, zero);
+		dhi = _mm256_unpackhi_epi8(d, zero);
+		dlo = _over_avx2_div255(_mm256_mullo_epi16(dlo, ialo));
+		dhi = _over_avx2_div255(_mm256_mullo_epi16(dhi, iahi));
+		d = _mm256_packus_epi16(_mm256_add_epi16(slo, dlo),
+				_mm256_add_epi16(shi, dhi));
+		_mm256_storeu_si256((__m256i *)&dst[i], d);
+	}
+	_blit_over_scalar(&dst[i], &src[i], width - i, alpha);
+}
+
+__attribute__((target("avx2")))
+static __m256i _over_avx2_div255(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(0x80));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)),
+			8);
+}
+
+
+/* blit_bilinear_sse2 */
+__attribute__((target("sse2")))
+static __m128i _bilinear_sse2_lerp(__m128i p, __m128i q, __m128i weight);
+
+__attribute__((target("sse2")))
+static void _blit_bilinear_sse2(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i y = _mm_set1_epi16(wy);
+	size_t i;
+	size_t j;
+	int sx;
+	int sx1;
+	unsigned int w[4];
+	uint32_t p[4][4];
+	__m128i p0, p1, q0, q1;
+	__m128i wlo, whi;
+	__m128i plo, phi, qlo, qhi;
+
+	for(i = 0; i + 4 <= width; i += 4)
+	{
+		/* there is no gathering, only blend the pixels at once */
+		for(j = 0; j < 4; j++, fx += dx)
+		{
+			w[j] = _blit_sample(fx, src_width, &sx, &sx1);
+			p[0][j] = row0[sx];
+			p[1][j] = row0[sx1];
+			p[2][j] = row1[sx];
+			p[3][j] = row1[sx1];
+		}
+		p0 = _mm_loadu_si128((__m128i const *)p[0]);
+		p1 = _mm_loadu_si128((__m128i const *)p[1]);
+		q0 = _mm_loadu_si128((__m128i const *)p[2]);
+		q1 = _mm_loadu_si128((__m128i const *)p[3]);
+		wlo = _mm_setr_epi16(w[0], w[0], w[0], w[0],
+				w[1], w[1], w[1], w[1]);
+		whi = _mm_setr_epi16(w[2], w[2], w[2], w[2],
+				w[3], w[3], w[3], w[3]);
+		plo = _bilinear_sse2_lerp(_mm_unpacklo_epi8(p0, zero),
+				_mm_unpacklo_epi8(p1, zero), wlo);
+		phi = _bilinear_sse2_lerp(_mm_unpackhi_epi8(p0, zero),
+				_mm_unpackhi_epi8(p1, zero), whi);
+		qlo = _bilinear_sse2_lerp(_mm_unpacklo_epi8(q0, zero),
+				_mm_unpacklo_epi8(q1, zero), wlo);
+		qhi = _bilinear_sse2_lerp(_mm_unpackhi_epi8(q0, zero),
+				_mm_unpackhi_epi8(q1, zero), whi);
+		_mm_storeu_si128((__m128i *)&dst[i], _mm_packus_epi16(
+					_bilinear_sse2_lerp(plo, qlo, y),
+					_bilinear_sse2_lerp(phi, qhi, y)));
+	}
+	_blit_bilinear_scalar(&dst[i], row0, row1, wy, src_width, fx, dx,
+			width - i);
+}
+
+__attribute__((target("sse2")))
+static __m128i _bilinear_sse2_lerp(__m128i p, __m128i q, __m128i weight)
+{
+	/* weight goes from 0 (p) to 256 (q), as with _blit_lerp() */
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(p,
+					_mm_sub_epi16(_mm_set1_epi16(256),
+						weight)),
+				_mm_mullo_epi16(q, weight)), 8);
+}
+
+
+/* blit_over_sse2 */
+__attribute__((target("sse2")))
+static __m128i _over_sse2_div255(__m128i x);
+
+__attribute__((target("sse2")))
+static void _blit_over_sse2(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi16(0xff);
+	const __m128i a = _mm_set1_epi16(alpha);
+	size_t i;
+	__m128i s, d;
+	__m128i slo, shi, dlo, dhi;
+	__m128i ialo, iahi;
+
+	for(i = 0; i + 4 <= width; i += 4)
+	{
+		s = _mm_loadu_si128((__m128i const *)&src[i]);
+		d = _mm_loadu_si128((__m128i const *)&dst[i]);
+		slo = _mm_unpacklo_epi8(s, zero);
+		shi = _mm_unpackhi_epi8(s, zero);
+		if(alpha != 255)
+		{
+			slo = _over_sse2_div255(_mm_mullo_epi16(slo, a));
+			shi = _over_sse2_div255(_mm_mullo_epi16(shi, a));
+		}
+		/* broadcast the alpha channel of the source */
+		ialo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo,
+					_MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3));
+		iahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi,
+					_MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3));
+		ialo = _mm_xor_si128(ialo, mask);
+		iahi = _mm_xor_si128(iahi, mask);
+		dlo = _mm_unpacklo_epi8(d, zero);
+		dhi = _mm_unpackhi_epi8(d, zero);
+		dlo = _over_sse2_div255(_mm_mullo_epi16(dlo, ialo));
+		dhi = _over_sse2_div255(_mm_mullo_epi16(dhi, iahi));
+		d = _mm_packus_epi16(_mm_add_epi16(slo, dlo),
+				_mm_add_epi16(shi, dhi));
+		_mm_storeu_si128((__m128i *)&dst[i], d);
+	}
+	_blit_over_scalar(&dst[i], &src[i], width - i, alpha);
+}
+
+__attribute__((target("sse2")))
+static __m128i _over_sse2_div255(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(0x80));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+
+#ifdef BLIT_NEON
+/* blit_bilinear_neon */
+static uint16x8_t _bilinear_neon_lerp(uint16x8_t p, uint16x8_t q,
+		uint16x8_t weight);
+
+static void _blit_bilinear_neon(uint32_t * dst, uint32_t const * row0,
+		uint32_t const * row1, unsigned int wy, int src_width,
+		int32_t fx, int32_t dx, size_t width)
+{
+	const uint16x8_t y = vdupq_n_u16(wy);
+	size_t i;
+	size_t j;
+	int sx;
+	int sx1;
+	uint16_t w[4];
+	uint32_t p[4][4];
+	uint8x16_t p0, p1, q0, q1;
+	uint16x8_t wlo, whi;
+	uint16x8_t plo, phi, qlo, qhi;
+
+	for(i = 0; i + 4 <= width; i += 4)
+	{
+		/* there is no gathering, only blend the pixels at once */
+		for(j = 0; j < 4; j++, fx += dx)
+		{
+			w[j] = _blit_sample(fx, src_width, &sx, &sx1);
+			p[0][j] = row0[sx];
+			p[1][j] = row0[sx1];
+			p[2][j] = row1[sx];
+			p[3][j] = row1[sx1];
+		}
+		p0 = vreinterpretq_u8_u32(vld1q_u32(p[0]));
+		p1 = vreinterpretq_u8_u32(vld1q_u32(p[1]));
+		q0 = vreinterpretq_u8_u32(vld1q_u32(p[2]));
+		q1 = vreinterpretq_u8_u32(vld1q_u32(p[3]));
+		wlo = vcombine_u16(vdup_n_u16(w[0]), vdup_n_u16(w[1]));
+		whi = vcombine_u16(vdup_n_u16(w[2]), vdup_n_u16(w[3]));
+		plo = _bilinear_neon_lerp(vmovl_u8(vget_low_u8(p0)),
+				vmovl_u8(vget_low_u8(p1)), wlo);
+		phi = _bilinear_neon_lerp(vmovl_u8(vget_high_u8(p0)),
+				vmovl_u8(vget_high_u8(p1)), whi);
+		qlo = _bilinear_neon_lerp(vmovl_u8(vget_low_u8(q0)),
+				vmovl_u8(vget_low_u8(q1)), wlo);
+		qhi = _bilinear_neon_lerp(vmovl_u8(vget_high_u8(q0)),
+				vmovl_u8(vget_high_u8(q1)), whi);
+		plo = _bilinear_neon_lerp(plo, qlo, y);
+		phi = _bilinear_neon_lerp(phi, qhi, y);
+		vst1q_u32(&dst[i], vreinterpretq_u32_u8(vcombine_u8(
+					vmovn_u16(plo), vmovn_u16(phi))));
+	}
+	_blit_bilinear_scalar(&dst[i], row0, row1, wy, src_width, fx, dx,
+			width - i);
+}
+
+static uint16x8_t _bilinear_neon_lerp(uint16x8_t p, uint16x8_t q,
+		uint16x8_t weight)
+{
+	/* weight goes from 0 (p) to 256 (q), as with _blit_lerp() */
+	return vshrq_n_u16(vmlaq_u16(vmulq_u16(p, vsubq_u16(vdupq_n_u16(256),
+						weight)), q, weight), 8);
+}
+
+
+/* blit_over_neon */
+static void _blit_over_neon(uint32_t * dst, uint32_t const * src,
+		size_t width, unsigned int alpha)
+{
+	const uint8x8_t a = vdup_n_u8(alpha);
+	size_t i;
+	size_t c;
+	uint8x8x4_t s;
+	uint8x8x4_t d;
+	uint8x8_t ia;
+	uint16x8_t t;
+
+	for(i = 0; i + 8 <= width; i += 8)
+	{
+		/* channels are de-interleaved (B, G, R, A) */
+		s = vld4_u8((uint8_t const *)&src[i]);
+		d = vld4_u8((uint8_t const *)&dst[i]);
+		if(alpha != 255)
+			for(c = 0; c < 4; c++)
+			{
+				t = vmull_u8(s.val[c], a);
+				s.val[c] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+			}
+		ia = vmvn_u8(s.val[3]);
+		for(c = 0; c < 4; c++)
+		{
+			t = vmull_u8(d.val[c], ia);
+			d.val[c] = vqadd_u8(s.val[c], vraddhn_u16(t,
+						vrshrq_n_u16(t, 8)));
+		}
+		vst4_u8((uint8_t *)&dst[i], d);
+	}
+	_blit_over_scalar(&dst[i], &src[i], width - i, alpha);
+}
+#endif
@@ -0,0 +1,65 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#ifndef LOCKER_DEMOS_BLIT_H
+# define LOCKER_DEMOS_BLIT_H
+
+# include <sys/types.h>
+# include <stdint.h>
+
+
+/* Blit */
+/* pixels are premultiplied ARGB32, as with CAIRO_FORMAT_ARGB32 */
+/* types */
+typedef enum _BlitFilter
+{
+	BLIT_FILTER_NEAREST = 0,
+	BLIT_FILTER_BILINEAR
+} BlitFilter;
+# define BLIT_FILTER_LAST	BLIT_FILTER_BILINEAR
+# define BLIT_FILTER_COUNT	(BLIT_FILTER_LAST + 1)
+
+
+/* functions */
+/* select the kernels for the CPU (optional, otherwise done on first use) */
+void blit_init(void);
+
+/* name of the kernels selected */
+char const * blit_get_name(void);
+
+/* rows */
+void blit_copy(uint32_t * dst, uint32_t const * src, size_t width);
+void blit_over(uint32_t * dst, uint32_t const * src, size_t width,
+		unsigned int alpha);
+
+/* images */
+void blit_composite(unsigned char * dst, int dst_stride, int dst_width,
+		int dst_height, unsigned char const * src, int src_stride,
+		int src_width, int src_height, int x, int y, double scale,
+		unsigned int alpha, BlitFilter filter);
+
+#endif /* !LOCKER_DEMOS_BLIT_H */
@@ -31,10 +31,14 @@
 #include <sys/types.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include <gdk/gdkx.h>
 #include <System.h>
 #include "Locker/demo.h"
+#include "assets.h"
+#include "blit.h"
+#include "image.h"
 #include "../../config.h"
 
 /* constants */
@@ -47,6 +51,10 @@
 #ifndef DEMODIR
 # define DEMODIR	DATADIR "/gtk-2.0/demo"
 #endif
+/* duration of an animation cycle (in microseconds) */
+#define GTKDEMO_CYCLE	2400000
+/* scrolling speed (in pixels per second) */
+#define GTKDEMO_SCROLL	25
 
 /* macros */
 #ifndef MIN
@@ -72,27 +80,48 @@ typedef enum _GtkDemoImage
 #define GDI_LAST GDI_GNU_KEYS
 #define GDI_COUNT (GDI_LAST + 1)
 
-typedef struct _GtkDemoWindow
+typedef struct _GtkDemoSprite
 {
-	GdkWindow * window;
-	GdkPixbuf * frame;
-#if GTK_CHECK_VERSION(3, 0, 0)
-	cairo_t * cairo;
-#else
-	GdkPixmap * pixmap;
-#endif
-} GtkDemoWindow;
+	int x;
+	int y;
+	double scale;
+	unsigned int alpha;
+	/* area covered in the frame */
+	GdkRectangle area;
+} GtkDemoSprite;
+
+typedef struct _GtkDemoTarget
+{
+	unsigned char * buffer;
+	int stride;
+	int width;
+	int height;
+	/* frame being rendered, possibly in several parts */
+	gint64 time;
+	gboolean full;
+	/* areas covered by the images in the previous and current frames */
+	GdkRectangle previous[GDI_COUNT];
+	GdkRectangle areas[GDI_COUNT];
+} GtkDemoTarget;
 
 typedef struct _LockerDemo
 {
 	LockerDemoHelper * helper;
-	GdkPixbuf * images[GDI_COUNT];
-	GtkDemoWindow * windows;
-	size_t windows_cnt;
-	guint source;
-	guint frame_num;
+	LockerConfigSection * config;
+	/* decoded only while used */
+	Assets * assets;
+	/* decoded once for every size of monitor */
+	ImageBackground * background;
+	cairo_surface_t * images[GDI_COUNT];
 	int cycle;
+	ImageMode mode;
 	int scroll;
+	BlitFilter filter;
+
+	/* buffers rendered into, possibly from several threads */
+	GMutex * mutex;
+	GtkDemoTarget * targets;
+	size_t targets_cnt;
 } GtkDemo;
 
 
@@ -115,15 +144,16 @@ static const char * _gtkdemo_images[GDI_COUNT] =
 /* plug-in */
 static GtkDemo * _gtkdemo_init(LockerDemoHelper * helper);
 static void _gtkdemo_destroy(GtkDemo * gtkdemo);
-static int _gtkdemo_add(GtkDemo * gtkdemo, GdkWindow * window);
-static void _gtkdemo_remove(GtkDemo * gtkdemo, GdkWindow * window);
 static void _gtkdemo_start(GtkDemo * gtkdemo);
 static void _gtkdemo_stop(GtkDemo * gtkdemo);
 static void _gtkdemo_cycle(GtkDemo * gtkdemo);
+static int _gtkdemo_render(GtkDemo * gtkdemo, unsigned char * buffer,
+		int stride, GdkRectangle const * rect,
+		GdkRectangle const * clip, gint64 time);
 
-/* callbacks */
-static gboolean _gtkdemo_on_idle(gpointer data);
-static gboolean _gtkdemo_on_timeout(gpointer data);
+/* useful */
+static int _gtkdemo_load(GtkDemo * gtkdemo);
+static void _gtkdemo_unload(GtkDemo * gtkdemo);
 
 
 /* public */
@@ -137,11 +167,12 @@ LockerDemoDefinition plugin =
 	_gtkdemo_init,
 	_gtkdemo_destroy,
 	NULL,
-	_gtkdemo_add,
-	_gtkdemo_remove,
+	NULL,
+	NULL,
 	_gtkdemo_start,
 	_gtkdemo_stop,
-	_gtkdemo_cycle
+	_gtkdemo_cycle,
+	_gtkdemo_render
 };
 
 
@@ -149,8 +180,6 @@ LockerDemoDefinition plugin =
 /* functions */
 /* plug-in */
 /* gtkdemo_init */
-static GdkPixbuf * _init_image(GtkDemo * gtkdemo, size_t i);
-
 static GtkDemo * _gtkdemo_init(LockerDemoHelper * helper)
 {
 	GtkDemo * gtkdemo;
@@ -158,165 +187,46 @@ static GtkDemo * _gtkdemo_init(LockerDemoHelper * helper)
 
 	if((gtkdemo = object_new(sizeof(*gtkdemo))) == NULL)
 		return NULL;
+	blit_init();
 	gtkdemo->helper = helper;
+	gtkdemo->config = helper->config_section(helper->locker, "gtk-demo");
+	if((gtkdemo->assets = assets_new(gtkdemo, _gtkdemo_load,
+					_gtkdemo_unload)) == NULL)
+	{
+		object_delete(gtkdemo);
+		return NULL;
+	}
+	gtkdemo->background = NULL;
 	for(i = 0; i < GDI_COUNT; i++)
-		gtkdemo->images[i] = _init_image(gtkdemo, i);
-	gtkdemo->windows = NULL;
-	gtkdemo->windows_cnt = 0;
-	gtkdemo->source = 0;
-	gtkdemo->frame_num = 0;
+		gtkdemo->images[i] = NULL;
 	gtkdemo->cycle = 1;
+	gtkdemo->mode = IMAGE_MODE_TILE;
 	gtkdemo->scroll = 0;
+	gtkdemo->filter = BLIT_FILTER_NEAREST;
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	gtkdemo->mutex = g_new(GMutex, 1);
+	g_mutex_init(gtkdemo->mutex);
+#else
+	gtkdemo->mutex = g_mutex_new();
+#endif
+	gtkdemo->targets = NULL;
+	gtkdemo->targets_cnt = 0;
 	return gtkdemo;
 }
 
-static GdkPixbuf * _init_image(GtkDemo * gtkdemo, size_t i)
-{
-	const unsigned int flags = GTK_ICON_LOOKUP_GENERIC_FALLBACK;
-	GdkPixbuf * pixbuf;
-	GtkIconTheme * icontheme;
-	GError * error = NULL;
-
-	if((pixbuf = gdk_pixbuf_new_from_file(_gtkdemo_images[i], &error))
-			!= NULL)
-		return pixbuf;
-	gtkdemo->helper->error(NULL, error->message, 1);
-	g_error_free(error);
-	if(i == GDI_BACKGROUND)
-		/* no background */
-		return NULL;
-	error = NULL;
-	icontheme = gtk_icon_theme_get_default();
-	if((pixbuf = gtk_icon_theme_load_icon(icontheme, "gtk-missing-image",
-					48, flags, &error)) != NULL)
-		return pixbuf;
-	gtkdemo->helper->error(NULL, error->message, 1);
-	g_error_free(error);
-	return NULL;
-}
-
-
 /* gtkdemo_destroy */
 static void _gtkdemo_destroy(GtkDemo * gtkdemo)
 {
-	size_t i;
-
 	_gtkdemo_stop(gtkdemo);
-	for(i = 0; i < GDI_COUNT; i++)
-		if(gtkdemo->images[i] != NULL)
-			g_object_unref(gtkdemo->images[i]);
-	object_delete(gtkdemo);
-}
-
-
-/* gtkdemo_add */
-static int _gtkdemo_add(GtkDemo * gtkdemo, GdkWindow * window)
-{
-	int ret = 0;
-	GtkDemoWindow * p;
-#if GTK_CHECK_VERSION(3, 0, 0)
-	GdkRGBA color = { 0.0, 0.0, 0.0, 0.0 };
-#else
-	GdkColor color = { 0x0, 0x0, 0x0, 0x0 };
-	GdkPixmap * pixmap;
-#endif
-	GdkPixbuf * background = gtkdemo->images[GDI_BACKGROUND];
-	GdkRectangle rect;
-	int width;
-	int height;
-#if !GTK_CHECK_VERSION(3, 0, 0)
-	int depth;
-#endif
-
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() window=%p\n", __func__, (void *)window);
-#endif
-	if((p = realloc(gtkdemo->windows, sizeof(*p) * (gtkdemo->windows_cnt
-						+ 1))) == NULL)
-		return -1;
-	gtkdemo->windows = p;
-	p = &gtkdemo->windows[gtkdemo->windows_cnt++];
-	gdk_window_get_geometry(window, &rect.x, &rect.y, &rect.width,
-			&rect.height
-#if !GTK_CHECK_VERSION(3, 0, 0)
-			, &depth
-#endif
-			);
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() (%dx%d), (%dx%d)@%dbpp\n", __func__,
-			rect.x, rect.y, rect.width, rect.height,
-# if GTK_CHECK_VERSION(3, 0, 0)
-			0);
-# else
-			depth);
-# endif
-#endif
-	/* set the default color */
-#if GTK_CHECK_VERSION(3, 0, 0)
-	gdk_window_set_background_rgba(window, &color);
-	p->cairo = gdk_cairo_create(window);
+	assets_delete(gtkdemo->assets);
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	g_mutex_clear(gtkdemo->mutex);
+	g_free(gtkdemo->mutex);
 #else
-	gdk_window_set_background(window, &color);
+	g_mutex_free(gtkdemo->mutex);
 #endif
-	/* draw background */
-	width = (background != NULL) ? gdk_pixbuf_get_width(background) : 0;
-	height = (background != NULL) ? gdk_pixbuf_get_height(background) : 0;
-	p->frame = gdk_pixbuf_new(GDK_COLORSPACE_RGB, 1, 8, rect.width,
-			rect.height);
-	if(width > 0 && height > 0)
-#if GTK_CHECK_VERSION(3, 0, 0)
-	{
-		gdk_pixbuf_copy_area(background, 0, 0, width, height, p->frame,
-				0, 0);
-		gdk_cairo_set_source_pixbuf(p->cairo, p->frame, 0, 0);
-		cairo_paint(p->cairo);
-	}
-#else
-	{
-		pixmap = gdk_pixmap_new(window, width, height, -1);
-		gdk_draw_pixbuf(pixmap, NULL, background, 0, 0, 0, 0, width,
-				height, GDK_RGB_DITHER_NONE, 0, 0);
-		gdk_window_set_back_pixmap(window, pixmap, FALSE);
-		gdk_pixmap_unref(pixmap);
-		gdk_window_clear(window);
-	}
-	p->pixmap = gdk_pixmap_new(window, rect.width, rect.width, -1);
-#endif
-	p->window = window;
-	return ret;
-}
-
-
-/* gtkdemo_remove */
-static void _gtkdemo_remove(GtkDemo * gtkdemo, GdkWindow * window)
-{
-	size_t i;
-
-	for(i = 0; i < gtkdemo->windows_cnt; i++)
-		if(gtkdemo->windows[i].window == window)
-		{
-			gtkdemo->windows[i].window = NULL;
-			g_object_unref(gtkdemo->windows[i].frame);
-			gtkdemo->windows[i].frame = NULL;
-#if GTK_CHECK_VERSION(3, 0, 0)
-			cairo_destroy(gtkdemo->windows[i].cairo);
-#else
-			gdk_pixmap_unref(gtkdemo->windows[i].pixmap);
-			gtkdemo->windows[i].pixmap = NULL;
-#endif
-		}
-	/* FIXME reorganize the array and free memory */
-	for(i = 0; i < gtkdemo->windows_cnt; i++)
-		if(gtkdemo->windows[i].window != NULL)
-			break;
-	if(i == gtkdemo->windows_cnt)
-	{
-		/* there are no windows left */
-		_gtkdemo_stop(gtkdemo);
-		free(gtkdemo->windows);
-		gtkdemo->windows = NULL;
-		gtkdemo->windows_cnt = 0;
-	}
+	free(gtkdemo->targets);
+	object_delete(gtkdemo);
 }
 
 
@@ -330,11 +240,26 @@ static void _gtkdemo_start(GtkDemo * gtkdemo)
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
 #endif
 	gtkdemo->scroll = 0;
-	if((p = helper->config_get(helper->locker, "gtk-demo", "scroll"))
-			!= NULL && strtol(p, NULL, 10) == 1)
+	if((p = helper->config_section_get(helper->locker, gtkdemo->config,
+					"scroll")) != NULL
+			&& strtol(p, NULL, 10) == 1)
 		gtkdemo->scroll = 1;
-	if(gtkdemo->source == 0)
-		_gtkdemo_on_timeout(gtkdemo);
+	/* scaling the images */
+	gtkdemo->filter = BLIT_FILTER_NEAREST;
+	if((p = helper->config_section_get(helper->locker, gtkdemo->config,
+					"filter")) != NULL
+			&& strcmp(p, "bilinear") == 0)
+		gtkdemo->filter = BLIT_FILTER_BILINEAR;
+	gtkdemo->mode = image_mode_from_string(helper->config_section_get(
+				helper->locker, gtkdemo->config,
+				"background_mode"));
+	/* decode the images only once needed */
+	assets_configure(gtkdemo->assets, helper, gtkdemo->config);
+	assets_acquire(gtkdemo->assets);
+	/* render every frame from scratch again */
+	g_mutex_lock(gtkdemo->mutex);
+	gtkdemo->targets_cnt = 0;
+	g_mutex_unlock(gtkdemo->mutex);
 }
 
 
@@ -344,9 +269,7 @@ static void _gtkdemo_stop(GtkDemo * gtkdemo)
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
 #endif
-	if(gtkdemo->source != 0)
-		g_source_remove(gtkdemo->source);
-	gtkdemo->source = 0;
+	assets_release(gtkdemo->assets);
 }
 
 
@@ -357,186 +280,352 @@ static void _gtkdemo_cycle(GtkDemo * gtkdemo)
 }
 
 
-/* callbacks */
-/* gtkdemo_on_idle */
-static gboolean _gtkdemo_on_idle(gpointer data)
-{
-	GtkDemo * gtkdemo = data;
-
-	gtkdemo->source = g_timeout_add(40, _gtkdemo_on_timeout, gtkdemo);
-	return FALSE;
-}
-
-
-/* gtkdemo_on_timeout */
-static void _timeout_window(GtkDemo * gtkdemo, GtkDemoWindow * window);
-static void _timeout_window_image(GtkDemo * gtkdemo, GtkDemoWindow * window,
-		double f, gint back_width, gint back_height, double xmid,
+/* gtkdemo_render */
+static void _render_damage(GtkDemo * gtkdemo, cairo_t * cairo,
+		GdkRectangle const * clip, GdkRectangle const * previous,
+		GdkRectangle const * current);
+static void _render_sprite(GtkDemo * gtkdemo, double f, double xmid,
 		double ymid, double fsin2pi, double fcos2pi, double radius,
-		size_t i);
-
-static gboolean _gtkdemo_on_timeout(gpointer data)
+		size_t i, GdkRectangle const * rect, GtkDemoSprite * sprite);
+static gboolean _render_target(GtkDemo * gtkdemo, unsigned char * buffer,
+		int stride, GdkRectangle const * rect, gint64 time,
+		GtkDemoSprite const * sprites, GdkRectangle * previous);
+
+static int _gtkdemo_render(GtkDemo * gtkdemo, unsigned char * buffer,
+		int stride, GdkRectangle const * rect,
+		GdkRectangle const * clip, gint64 time)
 {
-	GtkDemo * gtkdemo = data;
-	size_t i;
-
-	for(i = 0; i < gtkdemo->windows_cnt; i++)
-		_timeout_window(gtkdemo, &gtkdemo->windows[i]);
-	gtkdemo->frame_num++;
-	gtkdemo->source = g_idle_add(_gtkdemo_on_idle, gtkdemo);
-	return FALSE;
-}
-
-static void _timeout_window(GtkDemo * gtkdemo, GtkDemoWindow * window)
-{
-	GdkWindow * w;
-	GdkPixbuf * background = gtkdemo->images[GDI_BACKGROUND];
-	gint back_width = 0;
-	gint back_height = 0;
-	guint offset_x = 0;
-	guint offset_y = 0;
-	GdkRectangle rect;
-	int src_x;
-	int src_y;
-	int width;
-	int height;
-#if !GTK_CHECK_VERSION(3, 0, 0)
-	int depth;
-#endif
-	int j;
-#define CYCLE_LEN 60
+	cairo_surface_t * background = NULL;
+	int back_width = 0;
+	int back_height = 0;
+	int offset_x = 0;
+	int offset_y = 0;
+	gint64 offset;
 	double f;
 	double fsin2pi;
 	double fcos2pi;
-	int i;
+	size_t i;
 	double xmid, ymid;
 	double radius;
+	GtkDemoSprite sprites[GDI_COUNT];
+	GdkRectangle previous[GDI_COUNT];
+	gboolean full = TRUE;
+	cairo_surface_t * surface;
+	cairo_t * cairo;
 
-	if(window->window == NULL)
-		return;
-	w = window->window;
-	gdk_window_get_geometry(w, &rect.x, &rect.y, &rect.width, &rect.height
-#if !GTK_CHECK_VERSION(3, 0, 0)
-			, &depth
-#endif
-			);
-	/* reallocate the frame and background if necessary */
-	if(gdk_pixbuf_get_width(window->frame) != rect.width
-			|| gdk_pixbuf_get_height(window->frame) != rect.height)
+	f = (double) (time % GTKDEMO_CYCLE) / GTKDEMO_CYCLE;
+	fsin2pi = sin(f * 2.0 * G_PI);
+	fcos2pi = cos(f * 2.0 * G_PI);
+
+	xmid = rect->width / 2.0;
+	ymid = rect->height / 2.0;
+
+	radius = MIN(xmid, ymid) / 2.0;
+
+	for(i = 1; i < GDI_COUNT; i++)
+		_render_sprite(gtkdemo, f, xmid, ymid, fsin2pi, fcos2pi,
+				radius, i, rect, &sprites[i]);
+	/* only draw where the images were or are now if possible */
+	if(!_render_target(gtkdemo, buffer, stride, rect, time, sprites,
+				previous) && !gtkdemo->scroll)
+		full = FALSE;
+	/* draw directly into the buffer of the host, only within clip */
+	buffer += clip->y * stride + clip->x * 4;
+	surface = cairo_image_surface_create_for_data(buffer,
+			CAIRO_FORMAT_ARGB32, clip->width, clip->height, stride);
+	cairo_surface_set_device_offset(surface, -clip->x, -clip->y);
+	cairo = cairo_create(surface);
+	if(!full)
 	{
-		g_object_unref(window->frame);
-		window->frame = gdk_pixbuf_new(GDK_COLORSPACE_RGB, 1, 8,
-				rect.width, rect.height);
-#if GTK_CHECK_VERSION(3, 0, 0)
-		cairo_destroy(window->cairo);
-		window->cairo = gdk_cairo_create(w);
-#else
-		gdk_pixmap_unref(window->pixmap);
-		window->pixmap = gdk_pixmap_new(w, rect.width, rect.width, -1);
-#endif
+		for(i = 1; i < GDI_COUNT; i++)
+			_render_damage(gtkdemo, cairo, clip, &previous[i],
+					&sprites[i].area);
+		cairo_clip(cairo);
 	}
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() frame=%p\n", __func__,
-			(void *)window->frame);
-#endif
-
-	if(background != NULL)
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	/* scaled once for every size of monitor */
+	if(gtkdemo->background != NULL && (background = image_background_get(
+					gtkdemo->background, gtkdemo->scroll
+					? IMAGE_MODE_TILE : gtkdemo->mode,
+					rect->width, rect->height)) != NULL)
 	{
-		back_width = gdk_pixbuf_get_width(background);
-		back_height = gdk_pixbuf_get_height(background);
+		back_width = cairo_image_surface_get_width(background);
+		back_height = cairo_image_surface_get_height(background);
 		if(gtkdemo->scroll && back_width > 0 && back_height > 0)
 		{
-			offset_x = gtkdemo->frame_num % back_width;
-			offset_y = gtkdemo->frame_num % back_height;
+			offset = time * GTKDEMO_SCROLL / G_USEC_PER_SEC;
+			offset_x = offset % back_width;
+			offset_y = offset % back_height;
 		}
 	}
+	if(back_width <= 0 || back_height <= 0)
+		cairo_set_source_rgb(cairo, 0.0, 0.0, 0.0);
 	else
-		gdk_pixbuf_fill(window->frame, 0x000000ff);
-	src_y = offset_y;
-	for(j = 0; back_height > 0 && j < rect.height; j += height)
 	{
-		height = MIN(back_height - src_y, rect.height - j);
-		src_x = offset_x;
-		for(i = 0; back_width > 0 && i < rect.width; i += width)
-		{
-			width = MIN(back_width - src_x, rect.width - i);
-			gdk_pixbuf_copy_area(background, src_x, src_y,
-					width, height, window->frame, i, j);
-			src_x = 0;
-		}
-		src_y = 0;
+		/* scroll the background repeated (otherwise only copied when
+		 * already at the size of the monitor) */
+		cairo_set_source_surface(cairo, background, -offset_x,
+				-offset_y);
+		if(back_width != rect->width || back_height != rect->height
+				|| offset_x != 0 || offset_y != 0)
+			cairo_pattern_set_extend(cairo_get_source(cairo),
+					CAIRO_EXTEND_REPEAT);
 	}
+	cairo_paint(cairo);
+	cairo_destroy(cairo);
+	if(background != NULL)
+		cairo_surface_destroy(background);
+	/* composite the images directly */
+	cairo_surface_flush(surface);
+	for(i = 1; i < GDI_COUNT; i++)
+	{
+		if(sprites[i].area.width <= 0 || sprites[i].area.height <= 0)
+			continue;
+		blit_composite(buffer, stride, clip->width, clip->height,
+				cairo_image_surface_get_data(
+					gtkdemo->images[i]),
+				cairo_image_surface_get_stride(
+					gtkdemo->images[i]),
+				cairo_image_surface_get_width(
+					gtkdemo->images[i]),
+				cairo_image_surface_get_height(
+					gtkdemo->images[i]),
+				sprites[i].x - clip->x, sprites[i].y - clip->y,
+				sprites[i].scale, sprites[i].alpha,
+				gtkdemo->filter);
+	}
+	cairo_surface_destroy(surface);
+	return 0;
+}
 
-	f = (double) (gtkdemo->frame_num % CYCLE_LEN) / CYCLE_LEN;
-	fsin2pi = sin(f * 2.0 * G_PI);
-	fcos2pi = cos(f * 2.0 * G_PI);
-
-	back_width = rect.width;
-	back_height = rect.height;
-	xmid = back_width / 2.0;
-	ymid = back_height / 2.0;
-
-	radius = MIN(xmid, ymid) / 2.0;
+static void _render_damage(GtkDemo * gtkdemo, cairo_t * cairo,
+		GdkRectangle const * clip, GdkRectangle const * previous,
+		GdkRectangle const * current)
+{
+	LockerDemoHelper * helper = gtkdemo->helper;
+	GdkRectangle damage;
 
-	for(i = 1; i < GDI_COUNT; i++)
-		_timeout_window_image(gtkdemo, window, f, back_width,
-				back_height, xmid, ymid, fsin2pi, fcos2pi,
-				radius, i);
-#if GTK_CHECK_VERSION(3, 0, 0)
-	gdk_cairo_set_source_pixbuf(window->cairo, window->frame, 0, 0);
-	cairo_paint(window->cairo);
-#else
-	gdk_draw_pixbuf(window->pixmap, NULL, window->frame, 0, 0, 0, 0,
-			rect.width, rect.height, GDK_RGB_DITHER_NONE, 0, 0);
-	gdk_window_set_back_pixmap(w, window->pixmap, FALSE);
-	gdk_window_clear(w);
-#endif
+	if(previous->width <= 0 || previous->height <= 0)
+		damage = *current;
+	else if(current->width <= 0 || current->height <= 0)
+		damage = *previous;
+	else
+		gdk_rectangle_union(previous, current, &damage);
+	if(!gdk_rectangle_intersect(&damage, clip, &damage))
+	{
+		/* nothing changed here */
+		damage.width = 0;
+		damage.height = 0;
+	}
+	else
+		gdk_cairo_rectangle(cairo, &damage);
+	helper->frame_damage(helper->locker, &damage);
 }
 
-static void _timeout_window_image(GtkDemo * gtkdemo, GtkDemoWindow * window,
-		double f, gint back_width, gint back_height, double xmid,
+static void _render_sprite(GtkDemo * gtkdemo, double f, double xmid,
 		double ymid, double fsin2pi, double fcos2pi, double radius,
-		size_t i)
+		size_t i, GdkRectangle const * rect, GtkDemoSprite * sprite)
 {
 	double ang;
-	int xpos, ypos;
 	int iw, ih;
 	double r;
-	GdkRectangle r1, r2, dest;
 	double k;
+	GdkRectangle frame;
 
+	memset(sprite, 0, sizeof(*sprite));
 	if(gtkdemo->images[i] == NULL)
 		return;
 
 	ang = 2.0 * G_PI * (double) (i - 1) / (GDI_COUNT - 1) - f * 2.0 * G_PI;
 	ang = gtkdemo->cycle * ang;
 
-	iw = gdk_pixbuf_get_width(gtkdemo->images[i]);
-	ih = gdk_pixbuf_get_height(gtkdemo->images[i]);
+	iw = cairo_image_surface_get_width(gtkdemo->images[i]);
+	ih = cairo_image_surface_get_height(gtkdemo->images[i]);
 
 	r = radius + (radius / 3.0) * fsin2pi;
 
-	xpos = floor (xmid + r * cos (ang) - iw / 2.0 + 0.5);
-	ypos = floor (ymid + r * sin (ang) - ih / 2.0 + 0.5);
+	sprite->x = floor (xmid + r * cos (ang) - iw / 2.0 + 0.5);
+	sprite->y = floor (ymid + r * sin (ang) - ih / 2.0 + 0.5);
 
 	k = (i & 1) ? fsin2pi : fcos2pi;
 	k = 2.0 * k * k;
 	k = MAX (0.25, k);
 
-	r1.x = xpos;
-	r1.y = ypos;
-	r1.width = iw * k;
-	r1.height = ih * k;
-
-	r2.x = 0;
-	r2.y = 0;
-	r2.width = back_width;
-	r2.height = back_height;
-
-	if(gdk_rectangle_intersect(&r1, &r2, &dest))
-		gdk_pixbuf_composite(gtkdemo->images[i], window->frame,
-				dest.x, dest.y, dest.width, dest.height,
-				xpos, ypos, k, k, GDK_INTERP_NEAREST, ((i & 1)
-					? MAX(127, fabs(255 * fsin2pi))
-					: MAX(127, fabs(255 * fcos2pi))));
+	sprite->scale = k;
+	sprite->alpha = (i & 1)
+		? MAX(127, fabs(255 * fsin2pi))
+		: MAX(127, fabs(255 * fcos2pi));
+	sprite->area.x = sprite->x;
+	sprite->area.y = sprite->y;
+	sprite->area.width = ceil(iw * k);
+	sprite->area.height = ceil(ih * k);
+	frame.x = 0;
+	frame.y = 0;
+	frame.width = rect->width;
+	frame.height = rect->height;
+	if(!gdk_rectangle_intersect(&sprite->area, &frame, &sprite->area))
+	{
+		sprite->area.width = 0;
+		sprite->area.height = 0;
+	}
+}
+
+static gboolean _render_target(GtkDemo * gtkdemo, unsigned char * buffer,
+		int stride, GdkRectangle const * rect, gint64 time,
+		GtkDemoSprite const * sprites, GdkRectangle * previous)
+{
+	LockerDemoHelper * helper = gtkdemo->helper;
+	gboolean full = TRUE;
+	GtkDemoTarget * target;
+	int age;
+	size_t i;
+	size_t j;
+
+	age = helper->frame_age(helper->locker);
+	g_mutex_lock(gtkdemo->mutex);
+	/* buffers allocated again may replace any of the previous ones, so
+	 * only keep track of those already rendered for this frame */
+	if(age == 0)
+	{
+		for(i = 0, j = 0; i < gtkdemo->targets_cnt; i++)
+			if(gtkdemo->targets[i].time == time)
+				gtkdemo->targets[j++] = gtkdemo->targets[i];
+		gtkdemo->targets_cnt = j;
+	}
+	for(i = 0; i < gtkdemo->targets_cnt; i++)
+		if(gtkdemo->targets[i].buffer == buffer)
+			break;
+	if(i == gtkdemo->targets_cnt)
+	{
+		if((target = realloc(gtkdemo->targets, sizeof(*target)
+						* (i + 1))) == NULL)
+		{
+			g_mutex_unlock(gtkdemo->mutex);
+			return TRUE;
+		}
+		gtkdemo->targets = target;
+		gtkdemo->targets_cnt++;
+		target = &gtkdemo->targets[i];
+		memset(target, 0, sizeof(*target));
+		target->buffer = buffer;
+	}
+	else
+	{
+		target = &gtkdemo->targets[i];
+		if(target->time == time && target->stride == stride
+				&& target->width == rect->width
+				&& target->height == rect->height)
+		{
+			/* another part of the same frame */
+			memcpy(previous, target->previous,
+					sizeof(target->previous));
+			full = target->full;
+			g_mutex_unlock(gtkdemo->mutex);
+			return full;
+		}
+		/* the buffer may be at the same address but allocated again,
+		 * only its age tells if it still holds the previous frame */
+		full = (age != 1 || target->stride != stride
+				|| target->width != rect->width
+				|| target->height != rect->height);
+	}
+	target->stride = stride;
+	target->width = rect->width;
+	target->height = rect->height;
+	target->time = time;
+	target->full = full;
+	for(i = 1; i < GDI_COUNT; i++)
+	{
+		previous[i] = target->areas[i];
+		target->previous[i] = target->areas[i];
+		target->areas[i] = sprites[i].area;
+	}
+	g_mutex_unlock(gtkdemo->mutex);
+	return full;
+}
+
+
+/* useful */
+/* gtkdemo_load */
+static ImageBackground * _load_background(GtkDemo * gtkdemo);
+static cairo_surface_t * _load_image(GtkDemo * gtkdemo, size_t i);
+static cairo_surface_t * _load_image_missing(GtkDemo * gtkdemo);
+
+static int _gtkdemo_load(GtkDemo * gtkdemo)
+{
+	int ret = 0;
+	size_t i;
+
+	if((gtkdemo->background = _load_background(gtkdemo)) == NULL)
+		ret = -1;
+	for(i = GDI_BACKGROUND + 1; i < GDI_COUNT; i++)
+		if((gtkdemo->images[i] = _load_image(gtkdemo, i)) == NULL)
+			ret = -1;
+	return ret;
+}
+
+static ImageBackground * _load_background(GtkDemo * gtkdemo)
+{
+	ImageBackground * background;
+	GError * error = NULL;
+
+	/* only scaled when rendering, for the size of each monitor */
+	if((background = image_background_new(_gtkdemo_images[GDI_BACKGROUND],
+					&error)) != NULL)
+		return background;
+	/* no background */
+	gtkdemo->helper->error(NULL, error->message, 1);
+	g_error_free(error);
+	return NULL;
+}
+
+static cairo_surface_t * _load_image(GtkDemo * gtkdemo, size_t i)
+{
+	cairo_surface_t * surface;
+	GError * error = NULL;
+
+	/* decode the image once until evicted */
+	if((surface = image_load(_gtkdemo_images[i], 0, 0, &error)) != NULL)
+		return surface;
+	gtkdemo->helper->error(NULL, error->message, 1);
+	g_error_free(error);
+	return _load_image_missing(gtkdemo);
+}
+
+static cairo_surface_t * _load_image_missing(GtkDemo * gtkdemo)
+{
+	const unsigned int flags = GTK_ICON_LOOKUP_GENERIC_FALLBACK;
+	GdkPixbuf * pixbuf;
+	GtkIconTheme * icontheme;
+	GError * error = NULL;
+	cairo_surface_t * surface;
+
+	icontheme = gtk_icon_theme_get_default();
+	if((pixbuf = gtk_icon_theme_load_icon(icontheme, "gtk-missing-image",
+					48, flags, &error)) == NULL)
+	{
+		gtkdemo->helper->error(NULL, error->message, 1);
+		g_error_free(error);
+		return NULL;
+	}
+	surface = image_new_from_pixbuf(pixbuf);
+	g_object_unref(pixbuf);
+	return surface;
+}
+
+
+/* gtkdemo_unload */
+static void _gtkdemo_unload(GtkDemo * gtkdemo)
+{
+	size_t i;
+
+	if(gtkdemo->background != NULL)
+		image_background_delete(gtkdemo->background);
+	gtkdemo->background = NULL;
+	for(i = 0; i < GDI_COUNT; i++)
+		if(gtkdemo->images[i] != NULL)
+		{
+			cairo_surface_destroy(gtkdemo->images[i]);
+			gtkdemo->images[i] = NULL;
+		}
 }
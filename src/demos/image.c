@@ -0,0 +1,594 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <System.h>
+#include "image.h"
+#include "../../config.h"
+
+/* constants */
+#ifndef VENDOR
+# define VENDOR		"DeforaOS"
+#endif
+/* location of the cache, within $XDG_CACHE_HOME or ~/.cache */
+#define IMAGE_CACHE	"DeforaOS/" VENDOR "/" PACKAGE "/images"
+#define IMAGE_MAGIC	"LockerIm"
+#define IMAGE_VERSION	2
+/* sizes of every background kept around */
+#define IMAGE_SIZES	8
+/* stretched to the size given, if any */
+#define IMAGE_MODE_SCALE	IMAGE_MODE_COUNT
+
+
+/* Image */
+/* private */
+/* types */
+/* the cache files start with this header, then the filename of the image
+ * and finally its pixels, at offset */
+typedef struct _ImageHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t offset;
+	/* size requested */
+	uint32_t request_mode;
+	int32_t request_width;
+	int32_t request_height;
+	/* pixels */
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;
+	uint32_t filename;
+	/* image decoded */
+	int64_t mtime;
+	int64_t size;
+} ImageHeader;
+
+typedef struct _ImageSize
+{
+	ImageMode mode;
+	int width;
+	int height;
+	/* NULL if it could not be decoded */
+	cairo_surface_t * surface;
+} ImageSize;
+
+struct _ImageBackground
+{
+	String * filename;
+	/* looked up from several threads */
+	GMutex * mutex;
+	ImageSize * sizes;
+	size_t sizes_cnt;
+};
+
+
+/* constants */
+static char const * _image_modes[IMAGE_MODE_COUNT] =
+{
+	"tile",
+	"cover",
+	"fit"
+};
+
+
+/* variables */
+static const cairo_user_data_key_t _image_key;
+
+
+/* prototypes */
+static cairo_surface_t * _image_load(char const * filename,
+		unsigned int mode, int width, int height, GError ** error);
+static GdkPixbuf * _image_decode(char const * filename, unsigned int mode,
+		int width, int height, GError ** error);
+
+static String * _image_cache_path(char const * filename, unsigned int mode,
+		int width, int height);
+static cairo_surface_t * _image_cache_load(String const * path,
+		char const * filename, struct stat const * st,
+		unsigned int mode, int width, int height);
+static int _image_cache_save(String const * path, char const * filename,
+		struct stat const * st, unsigned int mode, int width,
+		int height, cairo_surface_t * surface);
+
+static void _image_unmap(void * data);
+
+
+/* public */
+/* functions */
+/* image_load */
+cairo_surface_t * image_load(char const * filename, int width, int height,
+		GError ** error)
+{
+	if(width <= 0 || height <= 0)
+		width = height = 0;
+	return _image_load(filename, IMAGE_MODE_SCALE, width, height, error);
+}
+
+
+/* image_new_from_pixbuf */
+cairo_surface_t * image_new_from_pixbuf(GdkPixbuf * pixbuf)
+{
+	cairo_surface_t * surface;
+	cairo_t * cairo;
+
+	surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+			gdk_pixbuf_get_width(pixbuf),
+			gdk_pixbuf_get_height(pixbuf));
+	cairo = cairo_create(surface);
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	gdk_cairo_set_source_pixbuf(cairo, pixbuf, 0.0, 0.0);
+	cairo_paint(cairo);
+	cairo_destroy(cairo);
+	if(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+	{
+		cairo_surface_destroy(surface);
+		return NULL;
+	}
+	cairo_surface_flush(surface);
+	return surface;
+}
+
+
+/* modes */
+/* image_mode_from_string */
+ImageMode image_mode_from_string(char const * string)
+{
+	unsigned int i;
+
+	if(string != NULL)
+		for(i = 0; i < IMAGE_MODE_COUNT; i++)
+			if(strcmp(_image_modes[i], string) == 0)
+				return i;
+	return IMAGE_MODE_TILE;
+}
+
+
+/* backgrounds */
+/* image_background_new */
+ImageBackground * image_background_new(char const * filename, GError ** error)
+{
+	ImageBackground * background;
+	int width;
+	int height;
+
+	/* only check the image for now */
+	if(gdk_pixbuf_get_file_info(filename, &width, &height) == NULL)
+	{
+		g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+				"%s: %s", filename, "Unsupported image");
+		return NULL;
+	}
+	if((background = object_new(sizeof(*background))) == NULL)
+		return NULL;
+	if((background->filename = string_new(filename)) == NULL)
+	{
+		object_delete(background);
+		return NULL;
+	}
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	background->mutex = g_new(GMutex, 1);
+	g_mutex_init(background->mutex);
+#else
+	background->mutex = g_mutex_new();
+#endif
+	background->sizes = NULL;
+	background->sizes_cnt = 0;
+	return background;
+}
+
+
+/* image_background_delete */
+void image_background_delete(ImageBackground * background)
+{
+	size_t i;
+
+	for(i = 0; i < background->sizes_cnt; i++)
+		if(background->sizes[i].surface != NULL)
+			cairo_surface_destroy(background->sizes[i].surface);
+	free(background->sizes);
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	g_mutex_clear(background->mutex);
+	g_free(background->mutex);
+#else
+	g_mutex_free(background->mutex);
+#endif
+	string_delete(background->filename);
+	object_delete(background);
+}
+
+
+/* image_background_get */
+cairo_surface_t * image_background_get(ImageBackground * background,
+		ImageMode mode, int width, int height)
+{
+	cairo_surface_t * ret = NULL;
+	ImageSize * s;
+	size_t i;
+
+	/* tiles are the same for every size */
+	if(mode == IMAGE_MODE_TILE || width <= 0 || height <= 0)
+	{
+		mode = IMAGE_MODE_TILE;
+		width = 0;
+		height = 0;
+	}
+	g_mutex_lock(background->mutex);
+	for(i = 0; i < background->sizes_cnt; i++)
+		if(background->sizes[i].mode == mode
+				&& background->sizes[i].width == width
+				&& background->sizes[i].height == height)
+			break;
+	if(i == background->sizes_cnt)
+	{
+		/* decode it once, forgetting the oldest size if necessary */
+		if(i == IMAGE_SIZES)
+		{
+			if(background->sizes[0].surface != NULL)
+				cairo_surface_destroy(
+						background->sizes[0].surface);
+			memmove(&background->sizes[0], &background->sizes[1],
+					sizeof(*s) * --i);
+			background->sizes_cnt = i;
+		}
+		else if((s = realloc(background->sizes, sizeof(*s) * (i + 1)))
+				== NULL)
+		{
+			g_mutex_unlock(background->mutex);
+			return NULL;
+		}
+		else
+			background->sizes = s;
+		s = &background->sizes[i];
+		s->mode = mode;
+		s->width = width;
+		s->height = height;
+		s->surface = _image_load(background->filename,
+				(mode == IMAGE_MODE_TILE) ? IMAGE_MODE_SCALE
+				: mode, width, height, NULL);
+		background->sizes_cnt++;
+	}
+	if(background->sizes[i].surface != NULL)
+		ret = cairo_surface_reference(background->sizes[i].surface);
+	g_mutex_unlock(background->mutex);
+	return ret;
+}
+
+
+/* private */
+/* functions */
+/* image_load */
+static cairo_surface_t * _image_load(char const * filename,
+		unsigned int mode, int width, int height, GError ** error)
+{
+	cairo_surface_t * ret;
+	cairo_surface_t * cached;
+	struct stat st;
+	String * path;
+	GdkPixbuf * pixbuf;
+	cairo_t * cairo;
+
+	if(stat(filename, &st) != 0)
+	{
+		g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno),
+				"%s: %s", filename, strerror(errno));
+		return NULL;
+	}
+	/* share the pixels decoded before if possible */
+	path = _image_cache_path(filename, mode, width, height);
+	if(path != NULL && (ret = _image_cache_load(path, filename, &st, mode,
+					width, height)) != NULL)
+	{
+		string_delete(path);
+		return ret;
+	}
+	if((pixbuf = _image_decode(filename, mode, width, height, error))
+			== NULL)
+	{
+		string_delete(path);
+		return NULL;
+	}
+	if(mode == IMAGE_MODE_SCALE)
+		ret = image_new_from_pixbuf(pixbuf);
+	else
+	{
+		/* center the image scaled in the area */
+		ret = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width,
+				height);
+		cairo = cairo_create(ret);
+		cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_rgb(cairo, 0.0, 0.0, 0.0);
+		cairo_paint(cairo);
+		gdk_cairo_set_source_pixbuf(cairo, pixbuf,
+				(width - gdk_pixbuf_get_width(pixbuf)) / 2,
+				(height - gdk_pixbuf_get_height(pixbuf)) / 2);
+		cairo_paint(cairo);
+		cairo_destroy(cairo);
+		if(cairo_surface_status(ret) != CAIRO_STATUS_SUCCESS)
+		{
+			cairo_surface_destroy(ret);
+			ret = NULL;
+		}
+		else
+			cairo_surface_flush(ret);
+	}
+	g_object_unref(pixbuf);
+	if(ret == NULL)
+		g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_NOMEM, "%s: %s",
+				filename, strerror(ENOMEM));
+	/* then share them with the next instances as well */
+	else if(path != NULL && _image_cache_save(path, filename, &st, mode,
+				width, height, ret) == 0
+			&& (cached = _image_cache_load(path, filename, &st,
+					mode, width, height)) != NULL)
+	{
+		cairo_surface_destroy(ret);
+		ret = cached;
+	}
+	string_delete(path);
+	return ret;
+}
+
+
+/* image_decode */
+static GdkPixbuf * _image_decode(char const * filename, unsigned int mode,
+		int width, int height, GError ** error)
+{
+	int w;
+	int h;
+	double scale;
+
+	if(width <= 0 || height <= 0)
+		return gdk_pixbuf_new_from_file(filename, error);
+	if(mode != IMAGE_MODE_SCALE)
+	{
+		if(gdk_pixbuf_get_file_info(filename, &w, &h) == NULL
+				|| w <= 0 || h <= 0)
+		{
+			g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+					"%s: %s", filename,
+					"Unsupported image");
+			return NULL;
+		}
+		scale = (mode == IMAGE_MODE_COVER)
+			? MAX((double)width / w, (double)height / h)
+			: MIN((double)width / w, (double)height / h);
+		width = MAX(1, (int)(w * scale + 0.5));
+		height = MAX(1, (int)(h * scale + 0.5));
+	}
+	/* let the loader scale the image down while decoding (with JPEG, in
+	 * the DCT domain already) */
+	return gdk_pixbuf_new_from_file_at_scale(filename, width, height,
+			FALSE, error);
+}
+
+
+/* image_cache_path */
+static String * _image_cache_path(char const * filename, unsigned int mode,
+		int width, int height)
+{
+	char const * cache;
+	char const * homedir;
+	uint64_t hash = 14695981039346656037ULL;
+	char const * p;
+	char buf[64];
+
+	/* FNV-1a */
+	for(p = filename; *p != '\0'; p++)
+		hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+	snprintf(buf, sizeof(buf), "/%016llx-%dx%d-%u",
+			(unsigned long long)hash, width, height, mode);
+	if((cache = getenv("XDG_CACHE_HOME")) != NULL && cache[0] == '/')
+		return string_new_append(cache, "/" IMAGE_CACHE, buf, NULL);
+	if((homedir = getenv("HOME")) != NULL)
+		return string_new_append(homedir, "/.cache/" IMAGE_CACHE, buf,
+				NULL);
+	return NULL;
+}
+
+
+/* image_cache_load */
+static cairo_surface_t * _image_cache_load(String const * path,
+		char const * filename, struct stat const * st,
+		unsigned int mode, int width, int height)
+{
+	cairo_surface_t * surface;
+	int fd;
+	struct stat sst;
+	unsigned char * map;
+	ImageHeader const * header;
+	size_t len = strlen(filename);
+
+	if((fd = open(path, O_RDONLY)) < 0)
+		return NULL;
+	if(fstat(fd, &sst) != 0 || (size_t)sst.st_size < sizeof(*header)
+			|| (map = mmap(NULL, sst.st_size, PROT_READ,
+					MAP_SHARED, fd, 0)) == MAP_FAILED)
+	{
+		close(fd);
+		return NULL;
+	}
+	/* the mapping remains valid once closed */
+	close(fd);
+	header = (ImageHeader const *)map;
+	if(memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != IMAGE_VERSION
+			|| header->request_mode != mode
+			|| header->request_width != width
+			|| header->request_height != height
+			|| header->mtime != (int64_t)st->st_mtime
+			|| header->size != (int64_t)st->st_size
+			|| header->filename != len
+			|| header->offset < sizeof(*header) + len
+			|| header->stride != (uint32_t)
+			cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32,
+				header->width)
+			|| header->offset + (uint64_t)header->stride
+			* header->height != (uint64_t)sst.st_size
+			|| memcmp(&header[1], filename, len) != 0)
+	{
+		/* outdated or invalid */
+		munmap(map, sst.st_size);
+		return NULL;
+	}
+	surface = cairo_image_surface_create_for_data(map + header->offset,
+			CAIRO_FORMAT_ARGB32, header->width, header->height,
+			header->stride);
+	if(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS
+			|| cairo_surface_set_user_data(surface, &_image_key,
+				map, _image_unmap) != CAIRO_STATUS_SUCCESS)
+	{
+		cairo_surface_destroy(surface);
+		munmap(map, sst.st_size);
+		return NULL;
+	}
+	return surface;
+}
+
+
+/* image_cache_save */
+static int _cache_save_mkdir(String * path);
+static int _cache_save_write(int fd, void const * buf, size_t size);
+
+static int _image_cache_save(String const * path, char const * filename,
+		struct stat const * st, unsigned int mode, int width,
+		int height, cairo_surface_t * surface)
+{
+	int ret;
+	ImageHeader header;
+	size_t len = strlen(filename);
+	char const zero[64] = "";
+	unsigned char const * data;
+	String * tmp;
+	int fd;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+	header.version = IMAGE_VERSION;
+	/* keep the pixels aligned */
+	header.offset = (sizeof(header) + len + sizeof(zero) - 1)
+		/ sizeof(zero) * sizeof(zero);
+	header.request_mode = mode;
+	header.request_width = width;
+	header.request_height = height;
+	header.width = cairo_image_surface_get_width(surface);
+	header.height = cairo_image_surface_get_height(surface);
+	header.stride = cairo_image_surface_get_stride(surface);
+	header.filename = len;
+	header.mtime = st->st_mtime;
+	header.size = st->st_size;
+	if(header.stride != (uint32_t)cairo_format_stride_for_width(
+				CAIRO_FORMAT_ARGB32, header.width)
+			|| (data = cairo_image_surface_get_data(surface))
+			== NULL)
+		return -1;
+	/* write a new file, then replace the previous one at once */
+	if((tmp = string_new_append(path, ".XXXXXX", NULL)) == NULL)
+		return -1;
+	if((fd = mkstemp(tmp)) < 0 && (errno != ENOENT
+				|| _cache_save_mkdir(tmp) != 0
+				|| (fd = mkstemp(tmp)) < 0))
+	{
+		string_delete(tmp);
+		return -1;
+	}
+	cairo_surface_flush(surface);
+	ret = (_cache_save_write(fd, &header, sizeof(header)) == 0
+			&& _cache_save_write(fd, filename, len) == 0
+			&& _cache_save_write(fd, zero, header.offset
+				- sizeof(header) - len) == 0
+			&& _cache_save_write(fd, data, (size_t)header.stride
+				* header.height) == 0) ? 0 : -1;
+	if(close(fd) != 0 || ret != 0 || rename(tmp, path) != 0)
+	{
+		unlink(tmp);
+		ret = -1;
+	}
+	string_delete(tmp);
+	return ret;
+}
+
+static int _cache_save_mkdir(String * path)
+{
+	size_t i;
+	char c;
+
+	/* create the parent directories, restoring the template as well */
+	for(i = 1; path[i] != '\0'; i++)
+	{
+		if(path[i] != '/')
+			continue;
+		c = path[i];
+		path[i] = '\0';
+		if(mkdir(path, 0700) != 0 && errno != EEXIST)
+		{
+			path[i] = c;
+			return -1;
+		}
+		path[i] = c;
+	}
+	/* mkstemp() modified the template */
+	memcpy(&path[strlen(path) - 6], "XXXXXX", 6);
+	return 0;
+}
+
+static int _cache_save_write(int fd, void const * buf, size_t size)
+{
+	unsigned char const * p = buf;
+	ssize_t s;
+
+	while(size > 0)
+		if((s = write(fd, p, size)) > 0)
+		{
+			p += s;
+			size -= s;
+		}
+		else if(s < 0 && errno == EINTR)
+			continue;
+		else
+			return -1;
+	return 0;
+}
+
+
+/* image_unmap */
+static void _image_unmap(void * data)
+{
+	ImageHeader const * header = data;
+
+	munmap(data, header->offset + (size_t)header->stride * header->height);
+}
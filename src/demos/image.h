@@ -0,0 +1,75 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+
+#ifndef LOCKER_DEMOS_IMAGE_H
+# define LOCKER_DEMOS_IMAGE_H
+
+# include <gtk/gtk.h>
+
+
+/* Image */
+/* images are premultiplied CAIRO_FORMAT_ARGB32 surfaces */
+/* types */
+typedef enum _ImageMode
+{
+	/* at the size of the image, to be repeated */
+	IMAGE_MODE_TILE = 0,
+	/* scaled to cover the area, and cropped */
+	IMAGE_MODE_COVER,
+	/* scaled to fit within the area, with borders */
+	IMAGE_MODE_FIT
+} ImageMode;
+# define IMAGE_MODE_LAST	IMAGE_MODE_FIT
+# define IMAGE_MODE_COUNT	(IMAGE_MODE_LAST + 1)
+
+typedef struct _ImageBackground ImageBackground;
+
+
+/* functions */
+/* decode an image, at the size given if positive, sharing the pixels decoded
+ * through a cache on disk */
+cairo_surface_t * image_load(char const * filename, int width, int height,
+		GError ** error);
+
+/* convert a pixbuf */
+cairo_surface_t * image_new_from_pixbuf(GdkPixbuf * pixbuf);
+
+/* modes */
+ImageMode image_mode_from_string(char const * string);
+
+/* backgrounds */
+/* decode an image once for every size of area it is drawn into */
+ImageBackground * image_background_new(char const * filename, GError ** error);
+void image_background_delete(ImageBackground * background);
+
+/* the image to draw at the origin of an area of the size given, from any
+ * thread (to release with cairo_surface_destroy()) */
+cairo_surface_t * image_background_get(ImageBackground * background,
+		ImageMode mode, int width, int height);
+
+#endif /* !LOCKER_DEMOS_IMAGE_H */
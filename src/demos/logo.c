@@ -34,6 +34,9 @@
 #include <time.h>
 #include <System.h>
 #include "Locker/demo.h"
+#include "assets.h"
+#include "blit.h"
+#include "image.h"
 #include "../../config.h"
 
 /* constants */
@@ -43,6 +46,10 @@
 #ifndef DATADIR
 # define DATADIR	PREFIX "/share"
 #endif
+/* the scrolling speed is set in pixels per frame at this rate */
+#define LOGO_FPS	25
+/* delay before moving the logo (in milliseconds) */
+#define LOGO_DELAY	10000
 
 /* macros */
 #ifndef MIN
@@ -60,28 +67,19 @@ typedef struct _LogoTheme
 	char const * logo;
 } LogoTheme;
 
-typedef struct _LogoWindow
-{
-	GdkWindow * window;
-	GdkPixbuf * frame;
-#if GTK_CHECK_VERSION(3, 0, 0)
-	cairo_t * cairo;
-#else
-	GdkPixmap * pixmap;
-#endif
-} LogoWindow;
-
 typedef struct _LockerDemo
 {
 	LockerDemoHelper * helper;
-	GdkPixbuf * background;
-	GdkPixbuf * logo;
-	LogoWindow * windows;
-	size_t windows_cnt;
-	guint source;
-	guint frame_num;
+	LockerConfigSection * config;
+	/* decoded only while used */
+	Assets * assets;
+	ImageBackground * background;
+	cairo_surface_t * logo;
+	unsigned int seed;
+	unsigned int cycle;
 
 	/* settings */
+	ImageMode mode;
 	int scroll;
 	int opacity;
 } Logo;
@@ -102,17 +100,17 @@ static const LogoTheme _logo_themes[] =
 static Logo * _logo_init(LockerDemoHelper * helper);
 static void _logo_destroy(Logo * logo);
 static void _logo_reload(Logo * logo);
-static int _logo_add(Logo * logo, GdkWindow * window);
-static void _logo_remove(Logo * logo, GdkWindow * window);
 static void _logo_start(Logo * logo);
 static void _logo_stop(Logo * logo);
 static void _logo_cycle(Logo * logo);
+static int _logo_render(Logo * logo, unsigned char * buffer, int stride,
+		GdkRectangle const * rect, GdkRectangle const * clip,
+		gint64 time);
 
 /* useful */
 static int _logo_load(Logo * logo);
-
-/* callbacks */
-static gboolean _logo_on_timeout(gpointer data);
+static cairo_surface_t * _logo_load_image(Logo * logo, char const * filename);
+static void _logo_unload(Logo * logo);
 
 
 /* public */
@@ -126,11 +124,12 @@ LockerDemoDefinition plugin =
 	_logo_init,
 	_logo_destroy,
 	_logo_reload,
-	_logo_add,
-	_logo_remove,
+	NULL,
+	NULL,
 	_logo_start,
 	_logo_stop,
-	_logo_cycle
+	_logo_cycle,
+	_logo_render
 };
 
 
@@ -144,19 +143,23 @@ static Logo * _logo_init(LockerDemoHelper * helper)
 
 	if((logo = object_new(sizeof(*logo))) == NULL)
 		return NULL;
+	blit_init();
 	/* initialization */
 	logo->helper = helper;
+	logo->config = helper->config_section(helper->locker, "logo");
+	if((logo->assets = assets_new(logo, _logo_load, _logo_unload)) == NULL)
+	{
+		object_delete(logo);
+		return NULL;
+	}
 	logo->background = NULL;
 	logo->logo = NULL;
-	logo->windows = NULL;
-	logo->windows_cnt = 0;
-	logo->source = 0;
-	logo->frame_num = 0;
+	logo->seed = time(NULL) ^ getpid() ^ getppid() ^ getuid() ^ getgid();
+	logo->cycle = 0;
+	logo->mode = IMAGE_MODE_TILE;
 	logo->scroll = 0;
 	logo->opacity = 255;
-	logo->background = NULL;
-	logo->logo = NULL;
-	_logo_load(logo);
+	_logo_reload(logo);
 	return logo;
 }
 
@@ -164,14 +167,8 @@ static Logo * _logo_init(LockerDemoHelper * helper)
 /* logo_destroy */
 static void _logo_destroy(Logo * logo)
 {
-#if GTK_CHECK_VERSION(3, 0, 0)
-	size_t i;
-
-	for(i = logo->windows_cnt; i > 0; i--)
-		if(logo->windows[i - 1].window != NULL)
-			_logo_remove(logo, logo->windows[i - 1].window);
-#endif
-	free(logo->windows);
+	_logo_stop(logo);
+	assets_delete(logo->assets);
 	object_delete(logo);
 }
 
@@ -184,95 +181,23 @@ static void _logo_reload(Logo * logo)
 	int opacity;
 
 	/* FIXME implement the rest */
+	assets_configure(logo->assets, helper, logo->config);
+	/* background */
+	if((p = helper->config_section_get(helper->locker, logo->config,
+					"background_mode")) != NULL)
+		logo->mode = image_mode_from_string(p);
 	/* scrolling */
-	if((p = helper->config_get(helper->locker, "logo", "scroll")) != NULL)
+	if((p = helper->config_section_get(helper->locker, logo->config,
+					"scroll")) != NULL)
 		logo->scroll = strtol(p, NULL, 10);
 	/* opacity */
-	if((p = helper->config_get(helper->locker, "logo", "opacity")) != NULL)
+	if((p = helper->config_section_get(helper->locker, logo->config,
+					"opacity")) != NULL)
 	{
 		opacity = strtol(p, NULL, 10);
 		if(opacity >= 0 && opacity <= 255)
 			logo->opacity = opacity;
 	}
-	if(logo->source != 0)
-	{
-		g_source_remove(logo->source);
-		logo->source = 0;
-	}
-	logo->source = g_idle_add(_logo_on_timeout, logo);
-}
-
-
-/* logo_add */
-static int _logo_add(Logo * logo, GdkWindow * window)
-{
-	LogoWindow * p;
-#if GTK_CHECK_VERSION(3, 0, 0)
-	GdkRGBA color = { 0.0, 0.0, 0.0, 0.0 };
-#else
-	GdkColor color = { 0x0, 0x0, 0x0, 0x0 };
-#endif
-
-#ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() window=%p\n", __func__, (void *)window);
-#endif
-	if((p = realloc(logo->windows, sizeof(*p) * (logo->windows_cnt + 1)))
-			== NULL)
-		return -1;
-	logo->windows = p;
-	p = &logo->windows[logo->windows_cnt++];
-	/* set the default color */
-#if GTK_CHECK_VERSION(3, 0, 0)
-	gdk_window_set_background_rgba(window, &color);
-#else
-	gdk_window_set_background(window, &color);
-	gdk_window_clear(window);
-#endif
-	p->window = window;
-	p->frame = NULL;
-#if GTK_CHECK_VERSION(3, 0, 0)
-	p->cairo = gdk_cairo_create(window);
-#else
-	p->pixmap = NULL;
-#endif
-	return 0;
-}
-
-
-/* logo_remove */
-static void _logo_remove(Logo * logo, GdkWindow * window)
-{
-	size_t i;
-
-	for(i = 0; i < logo->windows_cnt; i++)
-		if(logo->windows[i].window == window)
-		{
-			logo->windows[i].window = NULL;
-			if(logo->windows[i].frame != NULL)
-				g_object_unref(logo->windows[i].frame);
-			logo->windows[i].frame = NULL;
-#if GTK_CHECK_VERSION(3, 0, 0)
-			if(logo->windows[i].cairo != NULL)
-				cairo_destroy(logo->windows[i].cairo);
-			logo->windows[i].cairo = NULL;
-#else
-			if(logo->windows[i].pixmap != NULL)
-				gdk_pixmap_unref(logo->windows[i].pixmap);
-			logo->windows[i].pixmap = NULL;
-#endif
-		}
-	/* FIXME reorganize the array and free memory */
-	for(i = 0; i < logo->windows_cnt; i++)
-		if(logo->windows[i].window != NULL)
-			break;
-	if(i == logo->windows_cnt)
-	{
-		/* there are no windows left */
-		_logo_stop(logo);
-		free(logo->windows);
-		logo->windows = NULL;
-		logo->windows_cnt = 0;
-	}
 }
 
 
@@ -282,8 +207,8 @@ static void _logo_start(Logo * logo)
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
 #endif
-	if(logo->source == 0)
-		logo->source = g_idle_add(_logo_on_timeout, logo);
+	/* decode the images only once needed */
+	assets_acquire(logo->assets);
 }
 
 
@@ -293,9 +218,7 @@ static void _logo_stop(Logo * logo)
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
 #endif
-	if(logo->source != 0)
-		g_source_remove(logo->source);
-	logo->source = 0;
+	assets_release(logo->assets);
 }
 
 
@@ -305,9 +228,110 @@ static void _logo_cycle(Logo * logo)
 	/* cycle only when not scrolling */
 	if(logo->scroll != 0)
 		return;
-	if(logo->source != 0)
-		g_source_remove(logo->source);
-	logo->source = g_idle_add(_logo_on_timeout, logo);
+	logo->cycle++;
+}
+
+
+/* logo_render */
+static int _logo_render(Logo * logo, unsigned char * buffer, int stride,
+		GdkRectangle const * rect, GdkRectangle const * clip,
+		gint64 time)
+{
+	int width = 0;
+	int height = 0;
+	int x = 0;
+	int y = 0;
+	int offset_x = 0;
+	int offset_y = 0;
+	gint64 offset;
+	unsigned int seed;
+	cairo_surface_t * background = NULL;
+	cairo_surface_t * surface;
+	cairo_t * cairo;
+
+	/* draw directly into the buffer of the host, only within clip */
+	buffer += clip->y * stride + clip->x * 4;
+	surface = cairo_image_surface_create_for_data(buffer,
+			CAIRO_FORMAT_ARGB32, clip->width, clip->height, stride);
+	cairo_surface_set_device_offset(surface, -clip->x, -clip->y);
+	cairo = cairo_create(surface);
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	/* draw the background, scaled once for every size of monitor */
+	if(logo->background != NULL && (background = image_background_get(
+					logo->background, (logo->scroll != 0)
+					? IMAGE_MODE_TILE : logo->mode,
+					rect->width, rect->height)) != NULL)
+	{
+		width = cairo_image_surface_get_width(background);
+		height = cairo_image_surface_get_height(background);
+		if((logo->scroll != 0) && width > 0 && height > 0)
+		{
+			/* scroll according to the time elapsed */
+			offset = time * logo->scroll * LOGO_FPS
+				/ G_USEC_PER_SEC;
+			if((offset_x = offset % width) < 0)
+				offset_x += width;
+			if((offset_y = offset % height) < 0)
+				offset_y += height;
+		}
+	}
+	if(width <= 0 || height <= 0)
+		cairo_set_source_rgb(cairo, 0.0, 0.0, 0.0);
+	else
+	{
+		/* scroll the background repeated (otherwise only copied when
+		 * already at the size of the monitor) */
+		cairo_set_source_surface(cairo, background, -offset_x,
+				-offset_y);
+		if(width != rect->width || height != rect->height
+				|| offset_x != 0 || offset_y != 0)
+			cairo_pattern_set_extend(cairo_get_source(cairo),
+					CAIRO_EXTEND_REPEAT);
+	}
+	cairo_paint(cairo);
+	cairo_destroy(cairo);
+	if(background != NULL)
+		cairo_surface_destroy(background);
+	cairo_surface_flush(surface);
+	/* draw the logo */
+	if(logo->logo != NULL)
+	{
+		width = cairo_image_surface_get_width(logo->logo);
+		width = MIN(rect->width, width);
+		height = cairo_image_surface_get_height(logo->logo);
+		height = MIN(rect->height, height);
+		x = 0;
+		y = 0;
+		if(logo->scroll == 0)
+		{
+			/* move every LOGO_DELAY, the same on every monitor */
+			seed = logo->seed + logo->cycle
+				+ time / (LOGO_DELAY * 1000);
+			if(rect->width > width)
+				x = rand_r(&seed) % (rect->width - width);
+			if(rect->height > height)
+				y = rand_r(&seed) % (rect->height - height);
+		}
+		else
+		{
+			if(rect->width > width)
+				x = (rect->width - width) / 2;
+			if(rect->height > height)
+				y = (rect->height - height) / 2;
+		}
+		blit_composite(buffer, stride, clip->width, clip->height,
+				cairo_image_surface_get_data(logo->logo),
+				cairo_image_surface_get_stride(logo->logo),
+				cairo_image_surface_get_width(logo->logo),
+				cairo_image_surface_get_height(logo->logo),
+				x - clip->x, y - clip->y, 1.0, logo->opacity,
+				BLIT_FILTER_NEAREST);
+	}
+	cairo_surface_destroy(surface);
+	/* the frame only changes when scrolling */
+	if(logo->scroll != 0)
+		return 0;
+	return LOGO_DELAY - (time / 1000) % LOGO_DELAY;
 }
 
 
@@ -319,180 +343,74 @@ static int _logo_load(Logo * logo)
 	LockerDemoHelper * helper = logo->helper;
 	size_t i = LOGO_THEME_DEFAULT;
 	String const * p;
-	GdkPixbuf * pixbuf;
 	GError * error = NULL;
+	ImageBackground * background;
+	cairo_surface_t * surface;
 
 	/* load the theme configured */
-	if((p = helper->config_get(helper->locker, "logo", "theme")) != NULL)
+	if((p = helper->config_section_get(helper->locker, logo->config,
+					"theme")) != NULL)
 		for(i = 0; _logo_themes[i].name != NULL; i++)
 			if(strcmp(_logo_themes[i].name, p) == 0)
 				break;
 	/* load the background */
 	if((p = _logo_themes[i].background) == NULL
-			&& (p = helper->config_get(helper->locker, "logo",
-					"background")) == NULL)
+			&& (p = helper->config_section_get(helper->locker,
+					logo->config, "background")) == NULL)
 		p = _logo_themes[LOGO_THEME_DEFAULT].background;
-	if((pixbuf = gdk_pixbuf_new_from_file(p, &error)) == NULL)
+	if((background = image_background_new(p, &error)) == NULL)
 	{
-		ret = -helper->error(NULL, error->message, 1);
+		helper->error(NULL, error->message, 1);
 		g_error_free(error);
-		error = NULL;
+		ret = -1;
 	}
 	else
 	{
 		if(logo->background != NULL)
-			g_object_unref(logo->background);
-		logo->background = pixbuf;
+			image_background_delete(logo->background);
+		logo->background = background;
 	}
 	/* load the logo */
 	if((p = _logo_themes[i].logo) == NULL
-			&& (p = helper->config_get(helper->locker, "logo",
-					"logo")) == NULL)
+			&& (p = helper->config_section_get(helper->locker,
+					logo->config, "logo")) == NULL)
 		p = _logo_themes[LOGO_THEME_DEFAULT].logo;
-	if((pixbuf = gdk_pixbuf_new_from_file(p, &error)) == NULL)
-	{
-		ret = -helper->error(NULL, error->message, 1);
-		g_error_free(error);
-		error = NULL;
-	}
+	if((surface = _logo_load_image(logo, p)) == NULL)
+		ret = -1;
 	else
 	{
 		if(logo->logo != NULL)
-			g_object_unref(logo->logo);
-		logo->logo = pixbuf;
+			cairo_surface_destroy(logo->logo);
+		logo->logo = surface;
 	}
-	logo->scroll = 0;
-	logo->opacity = 255;
-	_logo_reload(logo);
 	return ret;
 }
 
 
-/* callbacks */
-/* logo_on_timeout */
-static void _timeout_window(Logo * logo, LogoWindow * window);
-
-static gboolean _logo_on_timeout(gpointer data)
+/* logo_load_image */
+static cairo_surface_t * _logo_load_image(Logo * logo, char const * filename)
 {
-	Logo * logo = data;
-	size_t i;
-
-	for(i = 0; i < logo->windows_cnt; i++)
-		_timeout_window(logo, &logo->windows[i]);
-	logo->frame_num += logo->scroll;
-	logo->source = g_timeout_add((logo->scroll != 0) ? 40 : 10000,
-			_logo_on_timeout, logo);
-	return FALSE;
-}
+	LockerDemoHelper * helper = logo->helper;
+	GError * error = NULL;
+	cairo_surface_t * surface;
 
-static void _timeout_window(Logo * logo, LogoWindow * window)
-{
-	GdkWindow * w;
-	GdkRectangle rect;
-#if !GTK_CHECK_VERSION(3, 0, 0)
-	int depth;
-#endif
-	GdkPixbuf * frame;
-	int width = 0;
-	int height = 0;
-	int i;
-	int j;
-	int x = 0;
-	int y = 0;
-	int offset_x = 0;
-	int offset_y = 0;
-	int src_x;
-	int src_y;
-	int src_w;
-	int src_h;
-	int seed = time(NULL) ^ getpid() ^ getppid() ^ getuid() ^ getgid();
-	const int black = 0x000000ff;
-
-	if((w = window->window) == NULL)
-		return;
-#if GTK_CHECK_VERSION(3, 0, 0)
-	gdk_window_get_geometry(w, &rect.x, &rect.y, &rect.width, &rect.height);
-#else
-	gdk_window_get_geometry(w, &rect.x, &rect.y, &rect.width, &rect.height,
-			&depth);
-#endif
-	/* reallocate the frame and background if necessary */
-	if(window->frame == NULL
-			|| gdk_pixbuf_get_width(window->frame) != rect.width
-			|| gdk_pixbuf_get_height(window->frame) != rect.height)
+	/* decode the image once and for all */
+	if((surface = image_load(filename, 0, 0, &error)) == NULL)
 	{
-		if(window->frame != NULL)
-			g_object_unref(window->frame);
-		window->frame = gdk_pixbuf_new(GDK_COLORSPACE_RGB, 1, 8,
-				rect.width, rect.height);
-#if GTK_CHECK_VERSION(3, 0, 0)
-		cairo_destroy(window->cairo);
-		window->cairo = gdk_cairo_create(window->window);
-#else
-		if(window->pixmap != NULL)
-			gdk_pixmap_unref(window->pixmap);
-		window->pixmap = gdk_pixmap_new(w, rect.width, rect.height, -1);
-#endif
+		helper->error(NULL, error->message, 1);
+		g_error_free(error);
 	}
-	frame = window->frame;
-	gdk_pixbuf_fill(frame, black);
-	/* draw the background */
+	return surface;
+}
+
+
+/* logo_unload */
+static void _logo_unload(Logo * logo)
+{
 	if(logo->background != NULL)
-	{
-		width = gdk_pixbuf_get_width(logo->background);
-		height = gdk_pixbuf_get_height(logo->background);
-		if((logo->scroll != 0) && width > 0 && height > 0)
-		{
-			offset_x = logo->frame_num % width;
-			offset_y = logo->frame_num % height;
-		}
-	}
-	src_y = offset_y;
-	for(j = 0; height > 0 && j < rect.height; j += src_h)
-	{
-		src_h = MIN(height - src_y, rect.height - j);
-		src_x = offset_x;
-		for(i = 0; width > 0 && i < rect.width; i += src_w)
-		{
-			src_w = MIN(width - src_x, rect.width - i);
-			gdk_pixbuf_copy_area(logo->background, src_x, src_y,
-					src_w, src_h, frame, i, j);
-			src_x = 0;
-		}
-		src_y = 0;
-	}
-	/* draw the logo */
+		image_background_delete(logo->background);
+	logo->background = NULL;
 	if(logo->logo != NULL)
-	{
-		width = gdk_pixbuf_get_width(logo->logo);
-		width = MIN(rect.width, width);
-		height = gdk_pixbuf_get_height(logo->logo);
-		height = MIN(rect.height, height);
-		if(logo->scroll == 0)
-		{
-			if(rect.width > width)
-				x = (rand() ^ seed) % (rect.width - width);
-			if(rect.height > height)
-				y = (rand() ^ seed) % (rect.height - height);
-		}
-		else
-		{
-			if(rect.width > width)
-				x = (rect.width - width) / 2;
-			if(rect.height > height)
-				y = (rect.height - height) / 2;
-		}
-		gdk_pixbuf_composite(logo->logo, frame, 0, 0,
-				rect.width, rect.height, x, y,
-				1.0, 1.0, GDK_INTERP_NEAREST, logo->opacity);
-	}
-#if GTK_CHECK_VERSION(3, 0, 0)
-	gdk_cairo_set_source_pixbuf(window->cairo, frame, 0, 0);
-	cairo_paint(window->cairo);
-#else
-	gdk_draw_pixbuf(window->pixmap, NULL, frame, 0, 0, 0, 0, rect.width,
-			rect.height, GDK_RGB_DITHER_NONE, 0, 0);
-	gdk_window_set_back_pixmap(w, window->pixmap, FALSE);
-	gdk_window_clear(w);
-#endif
+		cairo_surface_destroy(logo->logo);
+	logo->logo = NULL;
 }
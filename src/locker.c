@@ -34,7 +34,12 @@ static char const _license[] =
 # include <fcntl.h>
 #endif
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <dirent.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -42,6 +47,9 @@ static char const _license[] =
 #include <limits.h>
 #include <errno.h>
 #include <libintl.h>
+#if defined(__linux__)
+# include <sys/inotify.h>
+#endif
 #include <gdk/gdkx.h>
 #include <X11/Xatom.h>
 #include <X11/extensions/dpms.h>
@@ -49,6 +57,7 @@ static char const _license[] =
 #include <System.h>
 #include <Desktop.h>
 #include "locker.h"
+#include "control.h"
 #include "../config.h"
 #define _(string) gettext(string)
 #define N_(string) (string)
@@ -60,6 +69,29 @@ static char const _license[] =
 # define PROGNAME_LOCKER "locker"
 #endif
 
+/* delay before writing the configuration (in milliseconds) */
+#define LOCKER_CONFIG_DELAY	500
+
+/* frame rate of the demos rendered by the host (in frames per second) */
+#define LOCKER_DEMO_RATE	25
+/* areas reported damaged before presenting the whole frame instead */
+#define LOCKER_DEMO_DAMAGE	32
+/* threads rendering the demos, if the processors cannot be counted */
+#define LOCKER_DEMO_THREADS	4
+/* size of the parts of a frame rendered at once, to remain in the caches
+ * (in bytes) */
+#define LOCKER_DEMO_TILE	(256 * 1024)
+/* largest reduction of the resolution of the demos rendered by the host */
+#define LOCKER_DEMO_SCALE	4
+/* delay before returning the frames no longer used to the system, unless
+ * configured (in seconds) */
+#define LOCKER_DEMO_TRIM	30
+
+/* frame rate without a frame clock (in frames per second) */
+#define LOCKER_FRAME_RATE	60
+/* tolerance when pacing the frames (in microseconds) */
+#define LOCKER_FRAME_SLACK	4000
+
 
 /* Locker */
 /* private */
@@ -72,23 +104,174 @@ typedef enum _LockerGeneralColumn
 #define LGC_LAST LGC_DISPLAY
 #define LGC_COUNT (LGC_LAST + 1)
 
+typedef enum _LockerLatencyStage
+{
+	LLS_TRIGGER = 0,
+	LLS_ACTIVATED,
+	LLS_MAPPED,
+	LLS_PAINTED,
+	LLS_GRABBED,
+	LLS_LOCKED
+} LockerLatencyStage;
+#define LLS_LAST LLS_LOCKED
+#define LLS_COUNT (LLS_LAST + 1)
+
+#define LOCKER_LATENCY_BUCKETS	16
+
+typedef struct _LockerLatency
+{
+	unsigned long count;
+	gint64 min;
+	gint64 max;
+	gint64 total;
+	/* bucket i counts latencies below 2^i ms, the last one the rest */
+	unsigned long buckets[LOCKER_LATENCY_BUCKETS];
+} LockerLatency;
+
+typedef enum _LockerConfigReload
+{
+	LCR_AUTH = 0x01,
+	LCR_AUTH_CONFIG = 0x02,
+	LCR_DEMO = 0x04,
+	LCR_DEMO_CONFIG = 0x08,
+	LCR_PLUGINS = 0x10
+} LockerConfigReload;
+
+typedef struct _LockerConfigDiff
+{
+	Config * config;
+	Config * live;
+	Config * removed;
+	String const * section;
+	unsigned int changes;
+} LockerConfigDiff;
+
+typedef struct _LockerConfigWrite
+{
+	String * directory;
+	String * filename;
+	/* already written, to be synchronized and renamed */
+	String * temporary;
+	gint * writing;
+} LockerConfigWrite;
+
+typedef struct _LockerControlClient
+{
+	Locker * locker;
+	int fd;
+	GIOChannel * channel;
+	guint source;
+	LockerControlMessage request;
+	size_t request_cnt;
+	/* waiting for the screen to be locked */
+	gboolean wait;
+	/* answered once locked, or not */
+	gboolean replied;
+	/* following the events */
+	gboolean subscribed;
+} LockerControlClient;
+
+typedef struct _LockerDemoMemory
+{
+	unsigned char * data;
+	size_t size;
+	/* monotonic time until which to keep it around */
+	gint64 expires;
+} LockerDemoMemory;
+
+typedef struct _LockerDemoTile
+{
+	size_t buffer;
+	GdkRectangle clip;
+	int ret;
+	GdkRectangle damage[LOCKER_DEMO_DAMAGE];
+	size_t damage_cnt;
+} LockerDemoTile;
+
+typedef struct _LockerDemoBuffer
+{
+	unsigned char * data;
+	size_t size;
+	cairo_surface_t * surface;
+	GdkRectangle rect;
+	/* the window does not show the buffer anymore */
+	gboolean exposed;
+	/* part of the frame being rendered */
+	gboolean pending;
+	/* frames since the contents were rendered (0 if undefined) */
+	int age;
+	/* buffer holding the frame presented, possibly of another window */
+	size_t frame;
+	/* rendered separately, possibly in parallel */
+	LockerDemoTile * tiles;
+	size_t tiles_cnt;
+} LockerDemoBuffer;
+
+typedef struct _LockerFrame
+{
+	guint id;
+	unsigned int fps;
+	LockerDemoFrameFunc func;
+	gpointer data;
+	/* earliest time of the next frame */
+	gint64 next;
+} LockerFrame;
+
+struct _LockerConfigSection
+{
+	unsigned int hash;
+	String * name;
+	LockerConfigSection * next;
+};
+#define LOCKER_CONFIG_SECTIONS	32
+
 typedef struct _LockerPlugins
 {
 	char * name;
 	Plugin * pplugin;
 	LockerPluginDefinition * definition;
 	LockerPlugin * plugin;
+	unsigned int events;
 } LockerPlugins;
 
 struct _Locker
 {
 	/* settings */
 	Config * config;
+	guint cf_source;
+	GThread * cf_thread;
+	gint cf_writing;
+	/* hot reload */
+	int cw_fd;
+	GIOChannel * cw_channel;
+	guint cw_source;
+	guint cw_timeout;
+	gboolean cw_auth;
+	Config * manifest;
+	gboolean manifest_changed;
+	/* interned sections, hashed */
+	LockerConfigSection * sections[LOCKER_CONFIG_SECTIONS];
+
+	/* control */
+	int ct_fd;
+	char * ct_path;
+	GIOChannel * ct_channel;
+	guint ct_source;
+	LockerControlClient ** ct_clients;
+	size_t ct_clients_cnt;
+
+	/* status */
+	String * st_path;
+	LockerStatus * st_status;
+	gint64 st_locked;
+	unsigned int st_failed;
 
 	/* internal */
 	guint source;
 	gboolean enabled;
 	gboolean locked;
+	gboolean grabbed;
+	gboolean active;
 
 	GdkDisplay * display;
 	int screen;
@@ -96,22 +279,70 @@ struct _Locker
 	GtkWidget ** windows;
 	size_t windows_cnt;
 
+	/* latency */
+	gint64 lt_stages[LLS_COUNT];
+	/* the windows were already visible, nothing to record then */
+	gboolean lt_visible;
+	LockerLatency lt_stats[LLS_COUNT];
+
 	/* authentication */
+	String * aname;
 	Plugin * aplugin;
 	LockerAuthDefinition * adefinition;
 	LockerAuth * auth;
 	LockerAuthHelper ahelper;
 
 	/* demos */
+	String * dname;
 	Plugin * dplugin;
 	LockerDemoDefinition * ddefinition;
 	LockerDemo * demo;
 	LockerDemoHelper dhelper;
+	/* rendering on behalf of the demo */
+	guint dm_frame;
+	guint dm_source;
+	LockerDemoBuffer * dm_buffers;
+	size_t dm_buffers_cnt;
+	gint64 dm_elapsed;
+	/* the frames are rendered at a fraction of the resolution */
+	int dm_scale;
+	GThreadPool * dm_pool;
+	/* tiles rendered, and still to collect */
+	GAsyncQueue * dm_done;
+	size_t dm_jobs;
+	/* tiles still rendering */
+	gint dm_pending;
+	/* presenting the frames rendered */
+	gint dm_present;
+	/* memory of the frames no longer used */
+	LockerDemoMemory * dm_memory;
+	size_t dm_memory_cnt;
+	guint dm_trim;
+
+	/* frames */
+	LockerFrame * fr_frames;
+	size_t fr_frames_cnt;
+	guint fr_id;
+	gboolean fr_dispatching;
+	/* start of the demo, current frame and its deadline */
+	gint64 fr_start;
+	gint64 fr_current;
+	gint64 fr_deadline;
+	/* without a frame clock */
+	guint fr_source;
+	gint64 fr_time;
+#if GTK_CHECK_VERSION(3, 8, 0)
+	GdkFrameClock * fr_clock;
+	gulong fr_handler;
+#endif
 
 	/* plug-ins */
 	LockerPlugins * plugins;
 	size_t plugins_cnt;
 	LockerPluginHelper phelper;
+	/* indexes of the plug-ins handling each event */
+	size_t * pl_events[LOCKER_EVENT_COUNT];
+	size_t pl_events_cnt[LOCKER_EVENT_COUNT];
 
 	/* preferences */
 	GtkWidget * pr_window;
@@ -155,6 +386,41 @@ static char const * _authors[] =
 	NULL
 };
 
+static char const * _locker_events[LOCKER_EVENT_COUNT] =
+{
+	"activating",
+	"activated",
+	"cycling",
+	"cycled",
+	"deactivating",
+	"deactivated",
+	"locking",
+	"locked",
+	"suspending",
+	"unlocking",
+	"unlocked",
+	"auth-failed"
+};
+
+static char const * _locker_latency_stages[LLS_COUNT] =
+{
+	"trigger",
+	"activated",
+	"mapped",
+	"painted",
+	"grabbed",
+	"locked"
+};
+
+
+/* variables */
+/* part of a frame rendered by the current thread */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+static GPrivate _locker_demo_tile = G_PRIVATE_INIT(NULL);
+#else
+static GPrivate * _locker_demo_tile = NULL;
+#endif
+
 
 /* prototypes */
 /* accessors */
@@ -172,29 +438,64 @@ static int _locker_action(Locker * locker, LockerAction action);
 /* authentication */
 static char const * _locker_auth_config_get(Locker * locker,
 		char const * section, char const * variable);
+static void _locker_auth_failed(Locker * locker);
+static LockerConfigSection * _locker_auth_config_section(Locker * locker,
+		char const * section);
 static int _locker_auth_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value);
 static GtkWidget * _locker_auth_load(Locker * locker, char const * plugin);
+static void _locker_auth_reload(Locker * locker);
 static void _locker_auth_unload(Locker * locker);
 
 /* configuration */
+static int _locker_config_flush(Locker * locker);
 static int _locker_config_load(Locker * locker);
+static String * _locker_config_path(char const * filename);
+static int _locker_config_reload(Locker * locker);
 static int _locker_config_save(Locker * locker);
+static LockerConfigSection * _locker_config_section(Locker * locker,
+		char const * prefix, char const * section);
+static char const * _locker_config_section_get(Locker * locker,
+		LockerConfigSection const * section, char const * variable);
+
+/* control */
+static void _locker_control_close(Locker * locker,
+		LockerControlClient * client);
+static void _locker_control_event(Locker * locker, char const * event,
+		int monitor, char const * plugin);
+static void _locker_control_locked(Locker * locker,
+		LockerControlStatus status);
+static int _locker_control_reply(LockerControlClient * client,
+		LockerControlStatus status, void const * data, size_t length);
 
 static int _locker_cycle(Locker * locker, int force);
 
 static int _locker_deactivate(Locker * locker, int force);
 
 /* demos */
+static unsigned char * _locker_demo_alloc(Locker * locker, size_t size);
 static char const * _locker_demo_config_get(Locker * locker,
 		char const * section, char const * variable);
+static LockerConfigSection * _locker_demo_config_section(Locker * locker,
+		char const * section);
 static int _locker_demo_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value);
 static int _locker_demo_load(Locker * locker, char const * demo);
+static void _locker_demo_expose(Locker * locker, GtkWidget * widget);
+static void _locker_demo_flip(Locker * locker);
+static void _locker_demo_pool(Locker * locker);
+static LockerDemoBuffer * _locker_demo_prepare(Locker * locker, size_t i);
+static int _locker_demo_present(Locker * locker, size_t i);
+static void _locker_demo_refresh(Locker * locker);
+static void _locker_demo_release(Locker * locker, LockerDemoBuffer * buffer);
 static void _locker_demo_reload(Locker * locker);
+static void _locker_demo_render(Locker * locker, LockerDemoTile * tile);
+static void _locker_demo_scale(Locker * locker);
 static void _locker_demo_start(Locker * locker);
 static void _locker_demo_stop(Locker * locker);
+static void _locker_demo_trim(Locker * locker, gboolean all);
 static void _locker_demo_unload(Locker * locker);
+static void _locker_demo_wait(Locker * locker);
 
 static void _locker_disable(Locker * locker);
 static void _locker_enable(Locker * locker);
@@ -203,16 +504,55 @@ static int _locker_error(Locker * locker, char const * message, int ret);
 
 static int _locker_event(Locker * locker, LockerEvent event);
 
+/* frames */
+static guint _locker_frame_add(Locker * locker, unsigned int fps,
+		LockerDemoFrameFunc func, gpointer data);
+static int _locker_frame_age(Locker * locker);
+static void _locker_frame_compact(Locker * locker);
+static void _locker_frame_damage(Locker * locker, GdkRectangle const * area);
+static gint64 _locker_frame_deadline(Locker * locker);
+static void _locker_frame_dispatch(Locker * locker, gint64 time,
+		gint64 deadline);
+static gint64 _locker_frame_elapsed(Locker * locker);
+static unsigned int _locker_frame_rate(Locker * locker);
+static void _locker_frame_remove(Locker * locker, guint id);
+static void _locker_frame_start(Locker * locker);
+static void _locker_frame_stop(Locker * locker);
+
+/* latency */
+static void _locker_latency_cancel(Locker * locker);
+static String * _locker_latency_report(Locker * locker);
+static void _locker_latency_stage(Locker * locker, LockerLatencyStage stage);
+static void _locker_latency_start(Locker * locker);
+static void _locker_latency_window(Locker * locker, GtkWidget * widget,
+		LockerLatencyStage stage);
+
 static int _locker_lock(Locker * locker, int force);
 
+/* manifest */
+static String * _locker_manifest_entry(Locker * locker, char const * type,
+		char const * plugin);
+static char const * _locker_manifest_get(Locker * locker,
+		String const * entry, char const * variable);
+static int _locker_manifest_save(Locker * locker);
+
+static int _locker_mkdir(char * path);
+
 /* plug-ins */
 static char const * _locker_plugin_config_get(Locker * locker,
 		char const * section, char const * variable);
+static LockerConfigSection * _locker_plugin_config_section(Locker * locker,
+		char const * section);
 static int _locker_plugin_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value);
+static int _locker_plugin_dispatch(Locker * locker);
+static int _locker_plugin_init(Locker * locker, LockerPlugins * plugin);
 static int _locker_plugin_load(Locker * locker, char const * plugin);
 static int _locker_plugin_unload(Locker * locker, char const * plugin);
 
+/* status */
+static void _locker_status_update(Locker * locker);
+
 static int _locker_unlock(Locker * locker, int force);
 
 /* windows */
@@ -220,10 +560,35 @@ static void _locker_window_register(Locker * locker, size_t i);
 
 /* callbacks */
 static gboolean _locker_on_closex(void);
+static gboolean _locker_on_config_changed(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _locker_on_config_reload(gpointer data);
+static gboolean _locker_on_config_save(gpointer data);
+static gpointer _locker_on_config_write(gpointer data);
 static gboolean _locker_on_configure(GtkWidget * widget, GdkEvent * event,
 		gpointer data);
+static gboolean _locker_on_control(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _locker_on_control_client(GIOChannel * channel,
+		GIOCondition condition, gpointer data);
+static gboolean _locker_on_demo_frame(gint64 time, gpointer data);
+static gboolean _locker_on_demo_present(gpointer data);
+static void _locker_on_demo_render(gpointer data, gpointer user_data);
+static gboolean _locker_on_demo_timeout(gpointer data);
+static gboolean _locker_on_demo_trim(gpointer data);
+#if GTK_CHECK_VERSION(3, 0, 0)
+static gboolean _locker_on_draw(GtkWidget * widget, cairo_t * cairo,
+		gpointer data);
+#else
+static gboolean _locker_on_expose_event(GtkWidget * widget, GdkEvent * event,
+		gpointer data);
+#endif
 static GdkFilterReturn _locker_on_filter(GdkXEvent * xevent, GdkEvent * event,
 		gpointer data);
+static gboolean _locker_on_frame_timeout(gpointer data);
+#if GTK_CHECK_VERSION(3, 8, 0)
+static void _locker_on_frame_update(GdkFrameClock * clock, gpointer data);
+#endif
 static gboolean _locker_on_lock(gpointer data);
 static gboolean _locker_on_map_event(GtkWidget * widget, GdkEvent * event,
 		gpointer data);
@@ -239,8 +604,10 @@ static void _locker_on_realize(GtkWidget * widget, gpointer data);
 /* functions */
 /* locker_new */
 static int _new_config(Locker * locker);
+static int _new_control(Locker * locker);
 static void _new_helpers(Locker * locker);
 static int _new_plugins(Locker * locker);
+static int _new_status(Locker * locker);
 static int _new_xss(Locker * locker);
 
 Locker * locker_new(char const * demo, char const * auth)
@@ -257,10 +624,34 @@ Locker * locker_new(char const * demo, char const * auth)
 		_locker_error(NULL, error_get(NULL), 1);
 		return NULL;
 	}
+	locker->manifest = NULL;
+	locker->manifest_changed = FALSE;
+	memset(locker->sections, 0, sizeof(locker->sections));
 	_new_helpers(locker);
+	locker->config = NULL;
+	locker->cf_source = 0;
+	locker->cf_thread = NULL;
+	locker->cf_writing = 0;
+	locker->cw_fd = -1;
+	locker->cw_channel = NULL;
+	locker->cw_source = 0;
+	locker->cw_timeout = 0;
+	locker->cw_auth = FALSE;
+	locker->ct_fd = -1;
+	locker->ct_path = NULL;
+	locker->ct_channel = NULL;
+	locker->ct_source = 0;
+	locker->ct_clients = NULL;
+	locker->ct_clients_cnt = 0;
+	locker->st_path = NULL;
+	locker->st_status = NULL;
+	locker->st_locked = 0;
+	locker->st_failed = 0;
 	locker->source = 0;
 	locker->enabled = TRUE;
 	locker->locked = FALSE;
+	locker->grabbed = FALSE;
+	locker->active = FALSE;
 	locker->display = gdk_display_get_default();
 	screen = gdk_display_get_default_screen(locker->display);
 	locker->screen = gdk_x11_screen_get_screen_number(screen);
@@ -276,14 +667,48 @@ Locker * locker_new(char const * demo, char const * auth)
 		for(i = 0; i < cnt; i++)
 			locker->windows[i] = NULL;
 	locker->windows_cnt = cnt;
+	memset(locker->lt_stages, 0, sizeof(locker->lt_stages));
+	locker->lt_visible = FALSE;
+	memset(locker->lt_stats, 0, sizeof(locker->lt_stats));
+	locker->aname = NULL;
 	locker->aplugin = NULL;
 	locker->adefinition = NULL;
 	locker->auth = NULL;
+	locker->dname = NULL;
 	locker->dplugin = NULL;
 	locker->ddefinition = NULL;
 	locker->demo = NULL;
+	locker->dm_frame = 0;
+	locker->dm_source = 0;
+	locker->dm_buffers = NULL;
+	locker->dm_buffers_cnt = 0;
+	locker->dm_elapsed = 0;
+	locker->dm_scale = 1;
+	locker->dm_pool = NULL;
+	locker->dm_done = NULL;
+	locker->dm_jobs = 0;
+	locker->dm_pending = 0;
+	locker->dm_present = 0;
+	locker->dm_memory = NULL;
+	locker->dm_memory_cnt = 0;
+	locker->dm_trim = 0;
+	locker->fr_frames = NULL;
+	locker->fr_frames_cnt = 0;
+	locker->fr_id = 0;
+	locker->fr_dispatching = FALSE;
+	locker->fr_start = 0;
+	locker->fr_current = 0;
+	locker->fr_deadline = 0;
+	locker->fr_source = 0;
+	locker->fr_time = 0;
+#if GTK_CHECK_VERSION(3, 8, 0)
+	locker->fr_clock = NULL;
+	locker->fr_handler = 0;
+#endif
 	locker->plugins = NULL;
 	locker->plugins_cnt = 0;
+	memset(locker->pl_events, 0, sizeof(locker->pl_events));
+	memset(locker->pl_events_cnt, 0, sizeof(locker->pl_events_cnt));
 	locker->pr_window = NULL;
 	locker->ab_window = NULL;
 	/* check for errors */
@@ -298,6 +723,9 @@ Locker * locker_new(char const * demo, char const * auth)
 		return NULL;
 	}
 	_new_plugins(locker);
+	/* ignore errors */
+	if(_new_control(locker) == 0)
+		_new_status(locker);
 	/* create windows */
 	for(i = 0; i < locker->windows_cnt; i++)
 		_locker_window_register(locker, i);
@@ -319,10 +747,120 @@ Locker * locker_new(char const * demo, char const * auth)
 
 static int _new_config(Locker * locker)
 {
+#if defined(__linux__)
+	String * path;
+#endif
+
 	if((locker->config = config_new()) == NULL)
 		return -1;
 	/* ignore errors */
 	_locker_config_load(locker);
+#if defined(__linux__)
+	/* watch the configuration for changes (ignore errors) */
+	if((path = _locker_config_path(NULL)) == NULL)
+		return 0;
+	if(_locker_mkdir(path) == 0
+			&& (locker->cw_fd = inotify_init1(IN_NONBLOCK
+					| IN_CLOEXEC)) >= 0
+			&& inotify_add_watch(locker->cw_fd, path,
+				IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM
+				| IN_MOVED_TO) >= 0)
+	{
+		locker->cw_channel = g_io_channel_unix_new(locker->cw_fd);
+		locker->cw_source = g_io_add_watch(locker->cw_channel, G_IO_IN,
+				_locker_on_config_changed, locker);
+	}
+	else if(locker->cw_fd >= 0)
+	{
+		close(locker->cw_fd);
+		locker->cw_fd = -1;
+	}
+	string_delete(path);
+#endif
+	return 0;
+}
+
+static int _new_control(Locker * locker)
+{
+	struct sockaddr_un sa;
+	int fd;
+
+	if((locker->ct_path = locker_control_path(gdk_display_get_name(
+						locker->display))) == NULL)
+		return -_locker_error(NULL, strerror(errno), 1);
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", locker->ct_path);
+	if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return -_locker_error(NULL, strerror(errno), 1);
+	/* do not take over from another instance */
+	if(connect(fd, (struct sockaddr *)&sa, sizeof(sa)) == 0)
+	{
+		close(fd);
+		free(locker->ct_path);
+		locker->ct_path = NULL;
+		return -_locker_error(NULL, _("Already running"), 1);
+	}
+	close(fd);
+	unlink(locker->ct_path);
+	if((locker->ct_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0
+			|| fcntl(locker->ct_fd, F_SETFD, FD_CLOEXEC) != 0
+			|| fcntl(locker->ct_fd, F_SETFL, O_NONBLOCK) != 0
+			|| bind(locker->ct_fd, (struct sockaddr *)&sa,
+				sizeof(sa)) != 0
+			|| listen(locker->ct_fd, 8) != 0)
+	{
+		_locker_error(NULL, strerror(errno), 1);
+		if(locker->ct_fd >= 0)
+			close(locker->ct_fd);
+		locker->ct_fd = -1;
+		free(locker->ct_path);
+		locker->ct_path = NULL;
+		return -1;
+	}
+	locker->ct_channel = g_io_channel_unix_new(locker->ct_fd);
+	locker->ct_source = g_io_add_watch(locker->ct_channel, G_IO_IN,
+			_locker_on_control, locker);
+	return 0;
+}
+
+static int _new_status(Locker * locker)
+{
+	int fd;
+	LockerStatus * status;
+
+	if((locker->st_path = string_new_append(locker->ct_path,
+					LOCKER_STATUS_SUFFIX, NULL)) == NULL)
+		return -_locker_error(NULL, error_get(NULL), 1);
+	/* never share the page of a previous instance with the readers */
+	unlink(locker->st_path);
+	if((fd = open(locker->st_path, O_RDWR | O_CREAT | O_EXCL, 0644)) < 0)
+	{
+		string_delete(locker->st_path);
+		locker->st_path = NULL;
+		return -_locker_error(NULL, strerror(errno), 1);
+	}
+	if(ftruncate(fd, sizeof(*status)) != 0
+			|| (status = mmap(NULL, sizeof(*status),
+					PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+					0)) == MAP_FAILED)
+	{
+		_locker_error(NULL, strerror(errno), 1);
+		close(fd);
+		unlink(locker->st_path);
+		string_delete(locker->st_path);
+		locker->st_path = NULL;
+		return -1;
+	}
+	/* the mapping remains valid once closed */
+	close(fd);
+	memset(status, 0, sizeof(*status));
+	status->version = LOCKER_STATUS_VERSION;
+	status->pid = getpid();
+	locker->st_status = status;
+	_locker_status_update(locker);
+	/* let the readers know that the page is ready */
+	g_atomic_int_set((gint *)&status->magic, LOCKER_STATUS_MAGIC);
 	return 0;
 }
 
@@ -334,11 +872,22 @@ static void _new_helpers(Locker * locker)
 	locker->ahelper.action = _locker_action;
 	locker->ahelper.config_get = _locker_auth_config_get;
 	locker->ahelper.config_set = _locker_auth_config_set;
+	locker->ahelper.config_section = _locker_auth_config_section;
+	locker->ahelper.config_section_get = _locker_config_section_get;
+	locker->ahelper.failed = _locker_auth_failed;
 	/* demos helper */
 	locker->dhelper.locker = locker;
 	locker->dhelper.error = _locker_error;
 	locker->dhelper.config_get = _locker_demo_config_get;
 	locker->dhelper.config_set = _locker_demo_config_set;
+	locker->dhelper.config_section = _locker_demo_config_section;
+	locker->dhelper.config_section_get = _locker_config_section_get;
+	locker->dhelper.frame_add = _locker_frame_add;
+	locker->dhelper.frame_remove = _locker_frame_remove;
+	locker->dhelper.frame_damage = _locker_frame_damage;
+	locker->dhelper.frame_age = _locker_frame_age;
+	locker->dhelper.frame_elapsed = _locker_frame_elapsed;
+	locker->dhelper.frame_deadline = _locker_frame_deadline;
 	/* plug-ins helper */
 	locker->phelper.locker = locker;
 	locker->phelper.error = _locker_error;
@@ -346,6 +895,8 @@ static void _new_helpers(Locker * locker)
 	locker->phelper.action = _locker_action;
 	locker->phelper.config_get = _locker_plugin_config_get;
 	locker->phelper.config_set = _locker_plugin_config_set;
+	locker->phelper.config_section = _locker_plugin_config_section;
+	locker->phelper.config_section_get = _locker_config_section_get;
 }
 
 static int _new_plugins(Locker * locker)
@@ -375,6 +926,7 @@ static int _new_plugins(Locker * locker)
 		i = 0;
 	}
 	string_delete(plugins);
+	_locker_manifest_save(locker);
 	return ret;
 }
 
@@ -398,22 +950,61 @@ void locker_delete(Locker * locker)
 {
 	size_t i;
 	LockerPlugins * p;
+	LockerConfigSection * s;
 
 	if(locker->source != 0)
 		g_source_remove(locker->source);
+	/* stop listening for control requests */
+	while(locker->ct_clients_cnt > 0)
+		_locker_control_close(locker, locker->ct_clients[0]);
+	free(locker->ct_clients);
+	if(locker->ct_source != 0)
+		g_source_remove(locker->ct_source);
+	if(locker->ct_channel != NULL)
+		g_io_channel_unref(locker->ct_channel);
+	if(locker->ct_fd >= 0)
+		close(locker->ct_fd);
+	if(locker->ct_path != NULL)
+		unlink(locker->ct_path);
+	free(locker->ct_path);
+	/* stop publishing the status */
+	if(locker->st_status != NULL)
+		munmap(locker->st_status, sizeof(*locker->st_status));
+	if(locker->st_path != NULL)
+		unlink(locker->st_path);
+	string_delete(locker->st_path);
+	/* stop watching the configuration */
+	if(locker->cw_timeout != 0)
+		g_source_remove(locker->cw_timeout);
+	if(locker->cw_source != 0)
+		g_source_remove(locker->cw_source);
+	if(locker->cw_channel != NULL)
+		g_io_channel_unref(locker->cw_channel);
+	if(locker->cw_fd >= 0)
+		close(locker->cw_fd);
+	/* write the pending configuration changes */
+	if(locker->config != NULL)
+		_locker_config_flush(locker);
 	/* destroy the generic plug-ins */
 	for(i = 0; i < locker->plugins_cnt; i++)
 	{
 		p = &locker->plugins[i];
-		p->definition->destroy(p->plugin);
-		plugin_delete(p->pplugin);
+		if(p->plugin != NULL)
+			p->definition->destroy(p->plugin);
+		if(p->pplugin != NULL)
+			plugin_delete(p->pplugin);
 		free(p->name);
 	}
 	free(locker->plugins);
+	for(i = 0; i < LOCKER_EVENT_COUNT; i++)
+		free(locker->pl_events[i]);
 	/* destroy the authentication plug-in */
 	_locker_auth_unload(locker);
 	/* destroy the demo plug-in */
 	_locker_demo_unload(locker);
+	_locker_demo_trim(locker, TRUE);
+	_locker_frame_stop(locker);
+	free(locker->fr_frames);
 	/* destroy the windows */
 	for(i = 0; i < locker->windows_cnt; i++)
 		if(locker->windows[i] != NULL)
@@ -425,6 +1016,15 @@ void locker_delete(Locker * locker)
 			locker->screen);
 	if(locker->config != NULL)
 		config_delete(locker->config);
+	for(i = 0; i < LOCKER_CONFIG_SECTIONS; i++)
+		while((s = locker->sections[i]) != NULL)
+		{
+			locker->sections[i] = s->next;
+			string_delete(s->name);
+			object_delete(s);
+		}
+	if(locker->manifest != NULL)
+		config_delete(locker->manifest);
 	object_delete(locker);
 }
 
@@ -837,10 +1437,12 @@ static void _preferences_on_apply(gpointer data)
 	fprintf(stderr, "DEBUG: %s() auth=\"%s\"\n", __func__, p);
 #endif
 	config_set(locker->config, NULL, "auth", p);
-	/* XXX report errors */
 	i = _locker_get_primary_monitor(locker);
 	if((widget = _locker_auth_load(locker, p)) != NULL)
 		gtk_container_add(GTK_CONTAINER(locker->windows[i]), widget);
+	else
+		/* the current plug-in remains */
+		_locker_error(NULL, error_get(NULL), 1);
 	g_free(p);
 	/* demos */
 	p = NULL;
@@ -854,6 +1456,7 @@ static void _preferences_on_apply(gpointer data)
 	config_set(locker->config, NULL, "demo", p);
 	/* XXX check errors */
 	_locker_demo_load(locker, p);
+	_locker_status_update(locker);
 	g_free(p);
 	/* plug-ins */
 	i = 0;
@@ -896,11 +1499,13 @@ static void _preferences_on_cancel(gpointer data)
 	_cancel_demo(locker, locker->pr_dstore);
 	/* plug-ins */
 	_cancel_plugins(locker, locker->pr_plstore);
+	_locker_manifest_save(locker);
 }
 
 static void _cancel_auth(Locker * locker, GtkListStore * store)
 {
 	char const * q;
+	String * entry;
 	gboolean active;
 	GtkIconTheme * theme;
 	GtkTreeIter iter;
@@ -913,8 +1518,6 @@ static void _cancel_auth(Locker * locker, GtkListStore * store)
 #else
 	char const ext[] = ".so";
 #endif
-	Plugin * p;
-	LockerAuthDefinition * lad;
 	gint size = 24;
 
 	if((q = config_get(locker->config, NULL, "lock")) != NULL)
@@ -943,12 +1546,12 @@ static void _cancel_auth(Locker * locker, GtkListStore * store)
 #ifdef DEBUG
 		fprintf(stderr, "DEBUG: %s() \"%s\"\n", __func__, de->d_name);
 #endif
-		if((p = plugin_new(LIBDIR, PACKAGE, "auth", de->d_name))
-				== NULL)
+		if((entry = _locker_manifest_entry(locker, "auth",
+						de->d_name)) == NULL)
 			continue;
-		if((lad = plugin_lookup(p, "plugin")) == NULL)
+		if((q = _locker_manifest_get(locker, entry, "name")) == NULL)
 		{
-			plugin_delete(p);
+			string_delete(entry);
 			continue;
 		}
 #if GTK_CHECK_VERSION(2, 6, 0)
@@ -957,30 +1560,30 @@ static void _cancel_auth(Locker * locker, GtkListStore * store)
 		gtk_list_store_append(store, &iter);
 		gtk_list_store_set(store, &iter,
 #endif
-				LPC_FILENAME, de->d_name, LPC_NAME, lad->name,
-				-1);
+				LPC_FILENAME, de->d_name, LPC_NAME, q, -1);
 		/* select if currently active */
 		if(locker->adefinition != NULL
 				/* XXX check on de->d_name instead */
-				&& strcmp(locker->adefinition->name, lad->name)
-				== 0)
+				&& strcmp(locker->adefinition->name, q) == 0)
 			gtk_combo_box_set_active_iter(GTK_COMBO_BOX(
 						locker->pr_acombo), &iter);
 		icon = NULL;
-		if(lad->icon != NULL)
-			icon = gtk_icon_theme_load_icon(theme, lad->icon, size,
-					0, NULL);
+		if((q = _locker_manifest_get(locker, entry, "icon")) != NULL)
+			icon = gtk_icon_theme_load_icon(theme, q, size, 0,
+					NULL);
 		if(icon == NULL)
 			icon = gtk_icon_theme_load_icon(theme, "gnome-settings",
 					size, 0, NULL);
 		gtk_list_store_set(store, &iter, LPC_ICON, icon, -1);
-		plugin_delete(p);
+		string_delete(entry);
 	}
 	closedir(dir);
 }
 
 static void _cancel_demo(Locker * locker, GtkListStore * store)
 {
+	char const * q;
+	String * entry;
 	GtkIconTheme * theme;
 	GtkTreeIter iter;
 	GdkPixbuf * icon;
@@ -992,8 +1595,6 @@ static void _cancel_demo(Locker * locker, GtkListStore * store)
 #else
 	char const ext[] = ".so";
 #endif
-	Plugin * p;
-	LockerDemoDefinition * ldd;
 	gint size = 24;
 
 	theme = gtk_icon_theme_get_default();
@@ -1023,12 +1624,12 @@ static void _cancel_demo(Locker * locker, GtkListStore * store)
 		fprintf(stderr, "DEBUG: %s() \"%s\"\n", __func__,
 				de->d_name);
 #endif
-		if((p = plugin_new(LIBDIR, PACKAGE, "demos", de->d_name))
-				== NULL)
+		if((entry = _locker_manifest_entry(locker, "demos",
+						de->d_name)) == NULL)
 			continue;
-		if((ldd = plugin_lookup(p, "plugin")) == NULL)
+		if((q = _locker_manifest_get(locker, entry, "name")) == NULL)
 		{
-			plugin_delete(p);
+			string_delete(entry);
 			continue;
 		}
 #if GTK_CHECK_VERSION(2, 6, 0)
@@ -1037,25 +1638,23 @@ static void _cancel_demo(Locker * locker, GtkListStore * store)
 		gtk_list_store_append(store, &iter);
 		gtk_list_store_set(store, &iter,
 #endif
-				LPC_FILENAME, de->d_name, LPC_NAME, ldd->name,
-				-1);
+				LPC_FILENAME, de->d_name, LPC_NAME, q, -1);
 		/* select if currently active */
 		if(locker->ddefinition != NULL
 				/* XXX check on de->d_name instead */
-				&& strcmp(locker->ddefinition->name, ldd->name)
-				== 0)
+				&& strcmp(locker->ddefinition->name, q) == 0)
 			gtk_combo_box_set_active_iter(GTK_COMBO_BOX(
 						locker->pr_dcombo), &iter);
 		icon = NULL;
-		if(ldd->icon != NULL)
-			icon = gtk_icon_theme_load_icon(theme, ldd->icon, size,
-					0, NULL);
+		if((q = _locker_manifest_get(locker, entry, "icon")) != NULL)
+			icon = gtk_icon_theme_load_icon(theme, q, size, 0,
+					NULL);
 		if(icon == NULL)
 			icon = gtk_icon_theme_load_icon(theme, "gnome-settings",
 					size, 0, NULL);
 		if(icon != NULL)
 			gtk_list_store_set(store, &iter, LPC_ICON, icon, -1);
-		plugin_delete(p);
+		string_delete(entry);
 	}
 	closedir(dir);
 }
@@ -1120,6 +1719,8 @@ static void _cancel_general_dpms(Locker * locker)
 
 static void _cancel_plugins(Locker * locker, GtkListStore * store)
 {
+	char const * q;
+	String * entry;
 	GtkIconTheme * theme;
 	GtkTreeIter iter;
 	gboolean enabled;
@@ -1132,8 +1733,6 @@ static void _cancel_plugins(Locker * locker, GtkListStore * store)
 #else
 	char const ext[] = ".so";
 #endif
-	Plugin * p;
-	LockerPluginDefinition * lpd;
 
 	gtk_list_store_clear(store);
 	if((dir = opendir(LIBDIR "/" PACKAGE "/plugins")) == NULL)
@@ -1149,31 +1748,31 @@ static void _cancel_plugins(Locker * locker, GtkListStore * store)
 #ifdef DEBUG
 		fprintf(stderr, "DEBUG: %s() \"%s\"\n", __func__, de->d_name);
 #endif
-		if((p = plugin_new(LIBDIR, PACKAGE, "plugins", de->d_name))
-				== NULL)
+		if((entry = _locker_manifest_entry(locker, "plugins",
+						de->d_name)) == NULL)
 			continue;
-		if((lpd = plugin_lookup(p, "plugin")) == NULL)
+		if(_locker_manifest_get(locker, entry, "name") == NULL)
 		{
-			plugin_delete(p);
+			string_delete(entry);
 			continue;
 		}
 		enabled = _locker_plugin_is_enabled(locker, de->d_name);
 		icon = NULL;
-		if(lpd->icon != NULL)
-			icon = gtk_icon_theme_load_icon(theme, lpd->icon, 24, 0,
-					NULL);
+		if((q = _locker_manifest_get(locker, entry, "icon")) != NULL)
+			icon = gtk_icon_theme_load_icon(theme, q, 24, 0, NULL);
 		if(icon == NULL)
 			icon = gtk_icon_theme_load_icon(theme, "gnome-settings",
 					24, 0, NULL);
+		q = _locker_manifest_get(locker, entry, "name");
 #if GTK_CHECK_VERSION(2, 6, 0)
 		gtk_list_store_insert_with_values(store, &iter, -1,
 #else
 		gtk_list_store_append(store, &iter);
 		gtk_list_store_set(store, &iter,
 #endif
-				LPC_FILENAME, de->d_name, LPC_NAME, lpd->name,
+				LPC_FILENAME, de->d_name, LPC_NAME, q,
 				LPC_ENABLED, enabled, LPC_ICON, icon, -1);
-		plugin_delete(p);
+		string_delete(entry);
 	}
 	closedir(dir);
 }
@@ -1423,6 +2022,7 @@ static int _locker_action_enable(Locker * locker)
 
 static int _locker_action_lock(Locker * locker)
 {
+	_locker_latency_start(locker);
 	_locker_action_activate(locker);
 	return _locker_lock(locker, 1);
 }
@@ -1547,8 +2147,11 @@ static int _locker_activate(Locker * locker, int force)
 	window = locker->windows[primary]->window;
 #endif
 	gdk_window_focus(window, GDK_CURRENT_TIME);
+	locker->active = TRUE;
 	_locker_demo_start(locker);
+	_locker_status_update(locker);
 	_locker_event(locker, LOCKER_EVENT_ACTIVATED);
+	_locker_latency_stage(locker, LLS_ACTIVATED);
 	return 0;
 }
 
@@ -1557,14 +2160,11 @@ static int _locker_activate(Locker * locker, int force)
 static char const * _locker_auth_config_get(Locker * locker,
 		char const * section, char const * variable)
 {
-	char const * ret;
-	String * s;
+	LockerConfigSection * s;
 
-	if((s = string_new_append("auth::", section, NULL)) == NULL)
+	if((s = _locker_config_section(locker, "auth::", section)) == NULL)
 		return NULL;
-	ret = config_get(locker->config, s, variable);
-	string_delete(s);
-	return ret;
+	return config_get(locker->config, s->name, variable);
 }
 
 
@@ -1573,22 +2173,42 @@ static int _locker_auth_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value)
 {
 	int ret;
-	String * s;
+	LockerConfigSection * s;
 
-	if((s = string_new_append("auth::", section, NULL)) == NULL)
+	if((s = _locker_config_section(locker, "auth::", section)) == NULL)
 		return -1;
-	ret = config_set(locker->config, s, variable, value);
-	string_delete(s);
-	if(ret == 0)
+	if((ret = config_set(locker->config, s->name, variable, value)) == 0)
 		ret = _locker_config_save(locker);
 	return ret;
 }
 
 
+/* locker_auth_config_section */
+static LockerConfigSection * _locker_auth_config_section(Locker * locker,
+		char const * section)
+{
+	return _locker_config_section(locker, "auth::", section);
+}
+
+
+/* locker_auth_failed */
+static void _locker_auth_failed(Locker * locker)
+{
+	locker->st_failed++;
+	_locker_status_update(locker);
+	_locker_event(locker, LOCKER_EVENT_AUTH_FAILED);
+}
+
+
 /* locker_auth_load */
 static GtkWidget * _locker_auth_load(Locker * locker, char const * plugin)
 {
-	_locker_auth_unload(locker);
+	String * name;
+	Plugin * aplugin;
+	LockerAuthDefinition * adefinition;
+	LockerAuth * auth;
+	GtkWidget * widget;
+
 	if(plugin == NULL)
 		plugin = config_get(locker->config, NULL, "auth");
 	if(plugin == NULL)
@@ -1597,24 +2217,62 @@ static GtkWidget * _locker_auth_load(Locker * locker, char const * plugin)
 #else
 		plugin = "password";
 #endif
-	if((locker->aplugin = plugin_new(LIBDIR, PACKAGE, "auth", plugin))
-			== NULL)
+	/* keep the current plug-in until the new one is ready */
+	if((name = string_new(plugin)) == NULL)
 		return NULL;
-	if((locker->adefinition = plugin_lookup(locker->aplugin, "plugin"))
-			== NULL
-			|| locker->adefinition->init == NULL
-			|| locker->adefinition->destroy == NULL
-			|| locker->adefinition->get_widget == NULL
-			|| locker->adefinition->action == NULL
-			|| (locker->auth = locker->adefinition->init(
-					&locker->ahelper)) == NULL)
+	if((aplugin = plugin_new(LIBDIR, PACKAGE, "auth", plugin)) == NULL)
 	{
-		plugin_delete(locker->aplugin);
-		locker->adefinition = NULL;
-		locker->aplugin = NULL;
+		string_delete(name);
+		return NULL;
+	}
+	if((adefinition = plugin_lookup(aplugin, "plugin")) == NULL
+			|| adefinition->init == NULL
+			|| adefinition->destroy == NULL
+			|| adefinition->get_widget == NULL
+			|| adefinition->action == NULL)
+	{
+		error_set_code(1, "%s: %s", plugin, "Invalid plug-in");
+		plugin_delete(aplugin);
+		string_delete(name);
 		return NULL;
 	}
-	return locker->adefinition->get_widget(locker->auth);
+	if((auth = adefinition->init(&locker->ahelper)) == NULL)
+	{
+		plugin_delete(aplugin);
+		string_delete(name);
+		return NULL;
+	}
+	if((widget = adefinition->get_widget(auth)) == NULL)
+	{
+		error_set_code(1, "%s: %s", plugin, "Could not initialize");
+		adefinition->destroy(auth);
+		plugin_delete(aplugin);
+		string_delete(name);
+		return NULL;
+	}
+	_locker_auth_unload(locker);
+	locker->aname = name;
+	locker->aplugin = aplugin;
+	locker->adefinition = adefinition;
+	locker->auth = auth;
+	return widget;
+}
+
+
+/* locker_auth_reload */
+static void _locker_auth_reload(Locker * locker)
+{
+	size_t i;
+	GtkWidget * widget;
+
+	/* the current plug-in remains on errors */
+	if((widget = _locker_auth_load(locker, NULL)) == NULL)
+	{
+		_locker_error(NULL, error_get(NULL), 1);
+		return;
+	}
+	i = _locker_get_primary_monitor(locker);
+	gtk_container_add(GTK_CONTAINER(locker->windows[i]), widget);
 }
 
 
@@ -1628,6 +2286,88 @@ static void _locker_auth_unload(Locker * locker)
 		plugin_delete(locker->aplugin);
 	locker->adefinition = NULL;
 	locker->aplugin = NULL;
+	string_delete(locker->aname);
+	locker->aname = NULL;
+}
+
+
+/* locker_config_flush */
+static LockerConfigWrite * _config_flush_new(Locker * locker);
+static int _config_flush_new_temporary(Locker * locker,
+		LockerConfigWrite * lcw);
+
+static int _locker_config_flush(Locker * locker)
+{
+	LockerConfigWrite * lcw;
+
+	/* wait for the previous write to complete */
+	if(locker->cf_thread != NULL)
+		g_thread_join(locker->cf_thread);
+	locker->cf_thread = NULL;
+	if(locker->cf_source == 0)
+		/* nothing to write */
+		return 0;
+	g_source_remove(locker->cf_source);
+	locker->cf_source = 0;
+	if((lcw = _config_flush_new(locker)) == NULL)
+		return -_locker_error(NULL, error_get(NULL), 1);
+	return (_locker_on_config_write(lcw) == NULL) ? 0 : -1;
+}
+
+static LockerConfigWrite * _config_flush_new(Locker * locker)
+{
+	LockerConfigWrite * lcw;
+
+	if((lcw = object_new(sizeof(*lcw))) == NULL)
+		return NULL;
+	lcw->filename = NULL;
+	lcw->temporary = NULL;
+	lcw->writing = &locker->cf_writing;
+	if((lcw->directory = _locker_config_path(NULL)) == NULL
+			|| (lcw->filename = string_new_append(lcw->directory,
+					"/" LOCKER_CONFIG_FILE, NULL)) == NULL
+			|| (lcw->temporary = string_new_append(lcw->filename,
+					".XXXXXX", NULL)) == NULL
+			|| _config_flush_new_temporary(locker, lcw) != 0)
+	{
+		string_delete(lcw->directory);
+		string_delete(lcw->filename);
+		string_delete(lcw->temporary);
+		object_delete(lcw);
+		return NULL;
+	}
+	return lcw;
+}
+
+static int _config_flush_new_temporary(Locker * locker,
+		LockerConfigWrite * lcw)
+{
+	int fd;
+	struct stat st;
+	mode_t mode = 0600;
+
+	/* keep the permissions of the configuration file */
+	if(stat(lcw->filename, &st) == 0)
+		mode = st.st_mode & 07777;
+	if(_locker_mkdir(lcw->directory) != 0
+			|| (fd = mkstemp(lcw->temporary)) < 0)
+		return -error_set_code(1, "%s: %s", lcw->filename,
+				strerror(errno));
+	if(fchmod(fd, mode) != 0)
+	{
+		error_set_code(1, "%s: %s", lcw->temporary, strerror(errno));
+		close(fd);
+		unlink(lcw->temporary);
+		return -1;
+	}
+	close(fd);
+	/* serialize the configuration while still in the main thread */
+	if(config_save(locker->config, lcw->temporary) != 0)
+	{
+		unlink(lcw->temporary);
+		return -1;
+	}
+	return 0;
 }
 
 
@@ -1643,80 +2383,575 @@ static int _locker_config_load(Locker * locker)
 }
 
 
-/* locker_config_save */
-static int _locker_config_save(Locker * locker)
+/* locker_config_path */
+static String * _locker_config_path(char const * filename)
 {
-	int ret;
-
-	if((ret = config_save_preferences_user(locker->config,
-					LOCKER_CONFIG_VENDOR, PACKAGE,
-					LOCKER_CONFIG_FILE)) != 0)
-		_locker_error(NULL, error_get(NULL), 1);
+	String * ret;
+	char const * base;
+	char const * homedir;
+
+	/* same location as config_save_preferences_user() */
+	if((base = getenv("XDG_CONFIG_HOME")) != NULL && base[0] == '/')
+		ret = string_new_append(base,
+				"/" LOCKER_CONFIG_VENDOR "/" PACKAGE, NULL);
+	else if((homedir = getenv("HOME")) != NULL)
+		ret = string_new_append(homedir,
+				"/.config/" LOCKER_CONFIG_VENDOR "/" PACKAGE,
+				NULL);
+	else
+	{
+		error_set_code(1, "%s", "HOME: Not set");
+		return NULL;
+	}
+	if(ret != NULL && filename != NULL
+			&& (string_append(&ret, "/") != 0
+				|| string_append(&ret, filename) != 0))
+	{
+		string_delete(ret);
+		return NULL;
+	}
 	return ret;
 }
 
 
-/* locker_cycle */
-static int _locker_cycle(Locker * locker, int force)
+/* locker_config_reload */
+static void _config_reload_changed(LockerConfigDiff * diff,
+		String const * variable);
+static void _config_reload_plugins(Locker * locker);
+static int _config_reload_plugins_has(char const * plugins,
+		char const * plugin);
+static void _config_reload_removed(String const * section, void * data);
+static void _config_reload_removed_variable(String const * variable,
+		String const * value, void * data);
+static void _config_reload_section(String const * section, void * data);
+static void _config_reload_unset(String const * section, void * data);
+static void _config_reload_unset_variable(String const * variable,
+		String const * value, void * data);
+static void _config_reload_variable(String const * variable,
+		String const * value, void * data);
+
+static int _locker_config_reload(Locker * locker)
 {
-	if(force == 0 && _locker_event(locker, LOCKER_EVENT_CYCLING) != 0)
-		return -1;
-	if(locker->ddefinition != NULL && locker->ddefinition->cycle != NULL)
-		locker->ddefinition->cycle(locker->demo);
-	_locker_event(locker, LOCKER_EVENT_CYCLED);
+	LockerConfigDiff diff;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	if((diff.config = config_new()) == NULL)
+		return -_locker_error(NULL, error_get(NULL), 1);
+	if(config_load_preferences(diff.config, LOCKER_CONFIG_VENDOR, PACKAGE,
+				LOCKER_CONFIG_FILE) != 0
+			|| (diff.removed = config_new()) == NULL)
+	{
+		/* keep the current settings */
+		config_delete(diff.config);
+		return -_locker_error(NULL, error_get(NULL), 1);
+	}
+	diff.live = locker->config;
+	diff.changes = 0;
+	/* look for the values removed */
+	diff.section = "";
+	config_foreach_section(diff.live, diff.section,
+			_config_reload_removed_variable, &diff);
+	config_foreach(diff.live, _config_reload_removed, &diff);
+	/* apply the new and modified values */
+	diff.section = "";
+	config_foreach_section(diff.config, diff.section,
+			_config_reload_variable, &diff);
+	config_foreach(diff.config, _config_reload_section, &diff);
+	/* remove the values that are gone */
+	diff.section = "";
+	config_foreach_section(diff.removed, diff.section,
+			_config_reload_unset_variable, &diff);
+	config_foreach(diff.removed, _config_reload_unset, &diff);
+	config_delete(diff.removed);
+	config_delete(diff.config);
+	/* reload only what changed */
+	if(diff.changes & LCR_PLUGINS)
+		_config_reload_plugins(locker);
+	if((diff.changes & LCR_DEMO)
+			|| ((diff.changes & LCR_DEMO_CONFIG)
+				&& (locker->ddefinition == NULL
+					|| locker->ddefinition->reload
+					== NULL)))
+	{
+		/* advertise the demo loaded, or the lack thereof */
+		_locker_demo_load(locker, NULL);
+		_locker_status_update(locker);
+		if(locker->active)
+			_locker_demo_start(locker);
+	}
+	else if(diff.changes & LCR_DEMO_CONFIG)
+		_locker_demo_reload(locker);
+	if(diff.changes & (LCR_AUTH | LCR_AUTH_CONFIG))
+		locker->cw_auth = TRUE;
+	/* never replace the authentication plug-in while locked */
+	if(locker->cw_auth && locker->locked == FALSE)
+	{
+		locker->cw_auth = FALSE;
+		_locker_auth_reload(locker);
+	}
 	return 0;
 }
 
-
-/* locker_deactivate */
-static int _locker_deactivate(Locker * locker, int force)
+static void _config_reload_changed(LockerConfigDiff * diff,
+		String const * variable)
 {
-	if(force == 0 && _locker_event(locker, LOCKER_EVENT_DEACTIVATING) != 0)
-		return -1;
-	if(locker->locked == FALSE)
-		_locker_unlock(locker, force);
-	else if(locker->adefinition->action(locker->auth,
-				LOCKER_ACTION_DEACTIVATE) != 0)
-		return -1;
-	_locker_demo_stop(locker);
-	_locker_event(locker, LOCKER_EVENT_DEACTIVATED);
-	return 0;
+	if(diff->section[0] == '\0')
+	{
+		if(strcmp(variable, "auth") == 0)
+			diff->changes |= LCR_AUTH;
+		else if(strcmp(variable, "demo") == 0)
+			diff->changes |= LCR_DEMO;
+		else if(strcmp(variable, "plugins") == 0)
+			diff->changes |= LCR_PLUGINS;
+	}
+	else if(strncmp(diff->section, "auth::", 6) == 0)
+		diff->changes |= LCR_AUTH_CONFIG;
+	else if(strncmp(diff->section, "demo::", 6) == 0)
+		diff->changes |= LCR_DEMO_CONFIG;
 }
 
-
-/* locker_demo_config_get */
-static char const * _locker_demo_config_get(Locker * locker,
-		char const * section, char const * variable)
+static void _config_reload_plugins(Locker * locker)
 {
-	char const * ret;
-	String * s;
+	char const * p;
+	String * plugins;
+	String * q;
+	size_t i;
+	int c;
 
-	if((s = string_new_append("demo::", section, NULL)) == NULL)
-		return NULL;
-	ret = config_get(locker->config, s, variable);
-	string_delete(s);
-	return ret;
+	if((p = config_get(locker->config, NULL, "plugins")) == NULL)
+		p = "systray";
+	/* unload the plug-ins no longer listed */
+	for(i = locker->plugins_cnt; i > 0; i--)
+		if(!_config_reload_plugins_has(p, locker->plugins[i - 1].name))
+			_locker_plugin_unload(locker,
+					locker->plugins[i - 1].name);
+	/* load the plug-ins newly listed */
+	if(strlen(p) == 0 || (plugins = string_new(p)) == NULL)
+		return;
+	for(q = plugins, i = 0;; i++)
+	{
+		if(q[i] != ',' && q[i] != '\0')
+			continue;
+		c = q[i];
+		q[i] = '\0';
+		_locker_plugin_load(locker, q);
+		if(c == '\0')
+			break;
+		q += i + 1;
+		i = 0;
+	}
+	string_delete(plugins);
+	_locker_manifest_save(locker);
 }
 
-
-/* locker_demo_config_set */
-static int _locker_demo_config_set(Locker * locker, char const * section,
-		char const * variable, char const * value)
+static int _config_reload_plugins_has(char const * plugins,
+		char const * plugin)
 {
-	int ret;
-	String * s;
+	size_t len = strlen(plugin);
+	char const * p;
 
-	if((s = string_new_append("demo::", section, NULL)) == NULL)
-		return -1;
-	ret = config_set(locker->config, s, variable, value);
-	string_delete(s);
-	if(ret == 0)
-		ret = _locker_config_save(locker);
-	return ret;
+	for(p = plugins; p != NULL; p = strchr(p, ','))
+	{
+		if(*p == ',')
+			p++;
+		if(strncmp(p, plugin, len) == 0
+				&& (p[len] == ',' || p[len] == '\0'))
+			return 1;
+	}
+	return 0;
 }
 
+static void _config_reload_removed(String const * section, void * data)
+{
+	LockerConfigDiff * diff = data;
 
-/* locker_demo_load */
+	/* the default section was already handled */
+	if(section == NULL || section[0] == '\0')
+		return;
+	diff->section = section;
+	config_foreach_section(diff->live, section,
+			_config_reload_removed_variable, diff);
+}
+
+static void _config_reload_removed_variable(String const * variable,
+		String const * value, void * data)
+{
+	LockerConfigDiff * diff = data;
+
+	if(value != NULL && config_get(diff->config, diff->section, variable)
+			== NULL)
+		config_set(diff->removed, diff->section, variable, value);
+}
+
+static void _config_reload_section(String const * section, void * data)
+{
+	LockerConfigDiff * diff = data;
+
+	/* the default section was already handled */
+	if(section == NULL || section[0] == '\0')
+		return;
+	diff->section = section;
+	config_foreach_section(diff->config, section, _config_reload_variable,
+			diff);
+}
+
+static void _config_reload_unset(String const * section, void * data)
+{
+	LockerConfigDiff * diff = data;
+
+	/* the default section was already handled */
+	if(section == NULL || section[0] == '\0')
+		return;
+	diff->section = section;
+	config_foreach_section(diff->removed, section,
+			_config_reload_unset_variable, diff);
+}
+
+static void _config_reload_unset_variable(String const * variable,
+		String const * value, void * data)
+{
+	LockerConfigDiff * diff = data;
+	(void) value;
+
+	if(config_set(diff->live, diff->section, variable, NULL) == 0)
+		_config_reload_changed(diff, variable);
+}
+
+static void _config_reload_variable(String const * variable,
+		String const * value, void * data)
+{
+	LockerConfigDiff * diff = data;
+	char const * p;
+
+	if(value == NULL || ((p = config_get(diff->live, diff->section,
+						variable)) != NULL
+				&& strcmp(p, value) == 0))
+		/* this value did not change */
+		return;
+	if(config_set(diff->live, diff->section, variable, value) == 0)
+		_config_reload_changed(diff, variable);
+}
+
+
+/* locker_config_save */
+static int _locker_config_save(Locker * locker)
+{
+	/* coalesce the changes, and write them later in the background */
+	if(locker->cf_source == 0)
+		locker->cf_source = g_timeout_add(LOCKER_CONFIG_DELAY,
+				_locker_on_config_save, locker);
+	return 0;
+}
+
+
+/* locker_config_section */
+static LockerConfigSection * _locker_config_section(Locker * locker,
+		char const * prefix, char const * section)
+{
+	LockerConfigSection * s;
+	unsigned int hash = 2166136261U;
+	char const * p;
+	size_t len;
+
+	if(section == NULL)
+		return NULL;
+	/* FNV-1a */
+	for(p = prefix; *p != '\0'; p++)
+		hash = (hash ^ (unsigned char)*p) * 16777619U;
+	for(p = section; *p != '\0'; p++)
+		hash = (hash ^ (unsigned char)*p) * 16777619U;
+	len = strlen(prefix);
+	for(s = locker->sections[hash % LOCKER_CONFIG_SECTIONS]; s != NULL;
+			s = s->next)
+		if(s->hash == hash && strncmp(s->name, prefix, len) == 0
+				&& strcmp(&s->name[len], section) == 0)
+			return s;
+	/* intern this section */
+	if((s = object_new(sizeof(*s))) == NULL)
+		return NULL;
+	if((s->name = string_new_append(prefix, section, NULL)) == NULL)
+	{
+		object_delete(s);
+		return NULL;
+	}
+	s->hash = hash;
+	s->next = locker->sections[hash % LOCKER_CONFIG_SECTIONS];
+	locker->sections[hash % LOCKER_CONFIG_SECTIONS] = s;
+	return s;
+}
+
+
+/* locker_config_section_get */
+static char const * _locker_config_section_get(Locker * locker,
+		LockerConfigSection const * section, char const * variable)
+{
+	if(section == NULL)
+		return NULL;
+	return config_get(locker->config, section->name, variable);
+}
+
+
+/* control */
+/* locker_control_close */
+static void _locker_control_close(Locker * locker,
+		LockerControlClient * client)
+{
+	size_t i;
+
+	for(i = 0; i < locker->ct_clients_cnt; i++)
+		if(locker->ct_clients[i] == client)
+			break;
+	if(i < locker->ct_clients_cnt)
+		memmove(&locker->ct_clients[i], &locker->ct_clients[i + 1],
+				sizeof(*locker->ct_clients)
+				* (--locker->ct_clients_cnt - i));
+	if(client->source != 0)
+		g_source_remove(client->source);
+	g_io_channel_unref(client->channel);
+	close(client->fd);
+	object_delete(client);
+}
+
+
+/* locker_control_event */
+static void _locker_control_event(Locker * locker, char const * event,
+		int monitor, char const * plugin)
+{
+	char buf[256];
+	char m[16] = "-";
+	int len;
+	size_t i;
+	LockerControlClient * client;
+
+	if(monitor >= 0)
+		snprintf(m, sizeof(m), "%d", monitor);
+	/* event, monotonic time (in microseconds), monitor and plug-in */
+	if((len = snprintf(buf, sizeof(buf), "%s %" G_GINT64_FORMAT " %s %s\n",
+					event, g_get_monotonic_time(), m,
+					(plugin != NULL) ? plugin : "-")) < 0
+			|| (size_t)len >= sizeof(buf))
+		return;
+	for(i = 0; i < locker->ct_clients_cnt; i++)
+	{
+		if((client = locker->ct_clients[i])->subscribed == FALSE)
+			continue;
+		/* never block: drop the subscribers lagging behind */
+		if(locker_control_write(client->fd, buf, len) != 0)
+		{
+			client->subscribed = FALSE;
+			shutdown(client->fd, SHUT_RDWR);
+		}
+	}
+}
+
+
+/* locker_control_locked */
+static void _locker_control_locked(Locker * locker,
+		LockerControlStatus status)
+{
+	String * s = NULL;
+	char buf[64];
+	size_t i;
+	LockerControlClient * client;
+	int res = 0;
+
+	/* report the latency of every stage */
+	if(status == LOCKER_CONTROL_STATUS_OK && (s = string_new("")) != NULL)
+		for(i = LLS_TRIGGER + 1; i < LLS_COUNT; i++)
+		{
+			snprintf(buf, sizeof(buf), "%s: %.3fms\n",
+					_locker_latency_stages[i],
+					(locker->lt_stages[i]
+					 - locker->lt_stages[LLS_TRIGGER])
+					/ 1000.0);
+			res |= string_append(&s, buf);
+		}
+	for(i = 0; i < locker->ct_clients_cnt; i++)
+	{
+		if((client = locker->ct_clients[i])->wait == FALSE)
+			continue;
+		client->wait = FALSE;
+		client->replied = TRUE;
+		/* drop the clients not reading their reply, which is then
+		 * detected when reading from them */
+		if(_locker_control_reply(client, status, (res == 0) ? s : NULL,
+					(s != NULL && res == 0)
+					? string_get_length(s) : 0) != 0)
+			shutdown(client->fd, SHUT_RDWR);
+	}
+	string_delete(s);
+}
+
+
+/* locker_control_reply */
+static int _locker_control_reply(LockerControlClient * client,
+		LockerControlStatus status, void const * data, size_t length)
+{
+	LockerControlMessage reply;
+
+	/* the client is dropped if it would block (EAGAIN) */
+	reply = client->request;
+	reply.status = status;
+	reply.length = length;
+	if(locker_control_write(client->fd, &reply, sizeof(reply)) != 0
+			|| (length > 0 && locker_control_write(client->fd, data,
+					length) != 0))
+		return -1;
+	return 0;
+}
+
+
+/* locker_cycle */
+static int _locker_cycle(Locker * locker, int force)
+{
+	if(force == 0 && _locker_event(locker, LOCKER_EVENT_CYCLING) != 0)
+		return -1;
+	if(locker->ddefinition != NULL && locker->ddefinition->cycle != NULL)
+	{
+		_locker_demo_wait(locker);
+		locker->ddefinition->cycle(locker->demo);
+		_locker_demo_refresh(locker);
+	}
+	_locker_event(locker, LOCKER_EVENT_CYCLED);
+	return 0;
+}
+
+
+/* locker_deactivate */
+static int _locker_deactivate(Locker * locker, int force)
+{
+	if(force == 0 && _locker_event(locker, LOCKER_EVENT_DEACTIVATING) != 0)
+		return -1;
+	if(locker->locked == FALSE)
+		_locker_unlock(locker, force);
+	else if(locker->adefinition->action(locker->auth,
+				LOCKER_ACTION_DEACTIVATE) != 0)
+		return -1;
+	_locker_demo_stop(locker);
+	locker->active = FALSE;
+	_locker_status_update(locker);
+	_locker_latency_cancel(locker);
+	_locker_event(locker, LOCKER_EVENT_DEACTIVATED);
+	return 0;
+}
+
+
+/* locker_demo_alloc */
+static unsigned char * _locker_demo_alloc(Locker * locker, size_t size)
+{
+	unsigned char * data;
+	size_t i;
+
+	/* reuse the memory of a frame of the same size if possible */
+	for(i = 0; i < locker->dm_memory_cnt; i++)
+		if(locker->dm_memory[i].size == size)
+		{
+			data = locker->dm_memory[i].data;
+			memmove(&locker->dm_memory[i],
+					&locker->dm_memory[i + 1],
+					sizeof(*locker->dm_memory)
+					* (--locker->dm_memory_cnt - i));
+			return data;
+		}
+	/* aligned on pages, and returned to the system once released */
+	if((data = mmap(NULL, size, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANON, -1, 0))
+			== MAP_FAILED)
+	{
+		_locker_error(NULL, strerror(errno), 1);
+		return NULL;
+	}
+	return data;
+}
+
+
+/* locker_demo_config_get */
+static char const * _locker_demo_config_get(Locker * locker,
+		char const * section, char const * variable)
+{
+	LockerConfigSection * s;
+
+	if((s = _locker_config_section(locker, "demo::", section)) == NULL)
+		return NULL;
+	return config_get(locker->config, s->name, variable);
+}
+
+
+/* locker_demo_config_set */
+static int _locker_demo_config_set(Locker * locker, char const * section,
+		char const * variable, char const * value)
+{
+	int ret;
+	LockerConfigSection * s;
+
+	if((s = _locker_config_section(locker, "demo::", section)) == NULL)
+		return -1;
+	if((ret = config_set(locker->config, s->name, variable, value)) == 0)
+		ret = _locker_config_save(locker);
+	return ret;
+}
+
+
+/* locker_demo_config_section */
+static LockerConfigSection * _locker_demo_config_section(Locker * locker,
+		char const * section)
+{
+	return _locker_config_section(locker, "demo::", section);
+}
+
+
+/* locker_demo_expose */
+static void _locker_demo_expose(Locker * locker, GtkWidget * widget)
+{
+	size_t i;
+
+	/* present the whole frame again */
+	for(i = 0; i < locker->windows_cnt && i < locker->dm_buffers_cnt; i++)
+		if(locker->windows[i] == widget)
+		{
+			locker->dm_buffers[i].exposed = TRUE;
+			_locker_demo_refresh(locker);
+			break;
+		}
+}
+
+
+/* locker_demo_flip */
+static void _locker_demo_flip(Locker * locker)
+{
+	size_t i;
+	size_t j;
+	int delay = -1;
+	int ret;
+
+	/* present every frame rendered at once */
+	for(i = 0; i < locker->dm_buffers_cnt; i++)
+	{
+		if(locker->dm_buffers[i].pending == FALSE)
+			continue;
+		locker->dm_buffers[i].pending = FALSE;
+		/* the buffer now holds this frame, unless it failed */
+		locker->dm_buffers[i].age = 1;
+		for(j = 0; j < locker->dm_buffers[i].tiles_cnt; j++)
+			if(locker->dm_buffers[i].tiles[j].ret < 0)
+				locker->dm_buffers[i].age = 0;
+		if(i < locker->windows_cnt && (ret = _locker_demo_present(
+						locker, i)) >= 0)
+			delay = (delay < 0) ? ret : min(delay, ret);
+	}
+	if(delay <= 0 || locker->dm_frame == 0)
+		return;
+	/* the frames remain the same for a while */
+	_locker_frame_remove(locker, locker->dm_frame);
+	locker->dm_frame = 0;
+	locker->dm_source = g_timeout_add(delay, _locker_on_demo_timeout,
+			locker);
+}
+
+
+/* locker_demo_load */
 static int _locker_demo_load(Locker * locker, char const * demo)
 {
 	size_t i;
@@ -1726,9 +2961,13 @@ static int _locker_demo_load(Locker * locker, char const * demo)
 	if(demo == NULL && (demo = config_get(locker->config, NULL, "demo"))
 			== NULL)
 		return 0;
-	if((locker->dplugin = plugin_new(LIBDIR, PACKAGE, "demos", demo))
-			== NULL)
+	if((locker->dname = string_new(demo)) == NULL
+			|| (locker->dplugin = plugin_new(LIBDIR, PACKAGE,
+					"demos", demo)) == NULL)
+	{
+		_locker_demo_unload(locker);
 		return -1;
+	}
 	if((locker->ddefinition = plugin_lookup(locker->dplugin, "plugin"))
 			== NULL
 			|| locker->ddefinition->init == NULL
@@ -1739,6 +2978,8 @@ static int _locker_demo_load(Locker * locker, char const * demo)
 		plugin_delete(locker->dplugin);
 		locker->ddefinition = NULL;
 		locker->dplugin = NULL;
+		string_delete(locker->dname);
+		locker->dname = NULL;
 		return -1;
 	}
 	/* register the existing windows */
@@ -1758,31 +2999,419 @@ static int _locker_demo_load(Locker * locker, char const * demo)
 }
 
 
+/* locker_demo_pool */
+static void _locker_demo_pool(Locker * locker)
+{
+	gint cnt;
+	GError * error = NULL;
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+	cnt = g_get_num_processors();
+#else
+	cnt = LOCKER_DEMO_THREADS;
+	if(_locker_demo_tile == NULL
+			&& (_locker_demo_tile = g_private_new(NULL)) == NULL)
+		return;
+#endif
+	if((locker->dm_done = g_async_queue_new()) == NULL)
+		return;
+	if((locker->dm_pool = g_thread_pool_new(_locker_on_demo_render, locker,
+					cnt, FALSE, &error)) == NULL)
+	{
+		_locker_error(NULL, error->message, 1);
+		g_error_free(error);
+		g_async_queue_unref(locker->dm_done);
+		locker->dm_done = NULL;
+	}
+}
+
+
+/* locker_demo_prepare */
+static LockerDemoBuffer * _locker_demo_prepare(Locker * locker, size_t i)
+{
+	GdkWindow * window;
+	GdkRectangle rect;
+#if !GTK_CHECK_VERSION(3, 0, 0)
+	int depth;
+#endif
+	LockerDemoBuffer * buffer;
+	int stride;
+	long page;
+	size_t size;
+	LockerDemoTile * tile;
+	int rows;
+	size_t cnt;
+	size_t j;
+
+	if(locker->windows[i] == NULL)
+		return NULL;
+#if GTK_CHECK_VERSION(2, 14, 0)
+	if((window = gtk_widget_get_window(locker->windows[i])) == NULL)
+#else
+	if((window = locker->windows[i]->window) == NULL)
+#endif
+		return NULL;
+	gdk_window_get_geometry(window, &rect.x, &rect.y, &rect.width,
+			&rect.height
+#if !GTK_CHECK_VERSION(3, 0, 0)
+			, &depth
+#endif
+			);
+	if(rect.width <= 0 || rect.height <= 0)
+		return NULL;
+	/* render at a fraction of the resolution if configured */
+	rect.x /= locker->dm_scale;
+	rect.y /= locker->dm_scale;
+	rect.width = (rect.width + locker->dm_scale - 1) / locker->dm_scale;
+	rect.height = (rect.height + locker->dm_scale - 1) / locker->dm_scale;
+	if(i >= locker->dm_buffers_cnt)
+	{
+		if((buffer = realloc(locker->dm_buffers, sizeof(*buffer)
+						* (i + 1))) == NULL)
+			return NULL;
+		locker->dm_buffers = buffer;
+		for(j = locker->dm_buffers_cnt; j <= i; j++)
+		{
+			memset(&locker->dm_buffers[j], 0, sizeof(*buffer));
+			locker->dm_buffers[j].exposed = TRUE;
+			locker->dm_buffers[j].frame = j;
+		}
+		locker->dm_buffers_cnt = i + 1;
+	}
+	buffer = &locker->dm_buffers[i];
+	/* render the frame once for every window of the same size */
+	for(j = 0; j < i; j++)
+		if(locker->dm_buffers[j].pending
+				&& locker->dm_buffers[j].frame == j
+				&& locker->dm_buffers[j].rect.width
+				== rect.width
+				&& locker->dm_buffers[j].rect.height
+				== rect.height)
+			break;
+	if(j < i)
+	{
+		if(buffer->frame != j || locker->dm_buffers[j].exposed)
+			buffer->exposed = TRUE;
+		buffer->frame = j;
+		_locker_demo_release(locker, buffer);
+		free(buffer->tiles);
+		buffer->tiles = NULL;
+		buffer->tiles_cnt = 0;
+		buffer->rect = rect;
+		return buffer;
+	}
+	if(buffer->frame != i)
+	{
+		buffer->frame = i;
+		buffer->exposed = TRUE;
+	}
+	/* (re-)allocate the frame if necessary */
+	if(buffer->surface != NULL
+			&& (cairo_image_surface_get_width(buffer->surface)
+				!= rect.width
+				|| cairo_image_surface_get_height(
+					buffer->surface) != rect.height))
+		_locker_demo_release(locker, buffer);
+	if(buffer->surface == NULL)
+	{
+		stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32,
+				rect.width);
+		page = sysconf(_SC_PAGESIZE);
+		page = (page > 0) ? page : 4096;
+		size = ((size_t)stride * rect.height + page - 1) / page * page;
+		if((buffer->data = _locker_demo_alloc(locker, size)) == NULL)
+			return NULL;
+		buffer->size = size;
+		buffer->surface = cairo_image_surface_create_for_data(
+				buffer->data, CAIRO_FORMAT_ARGB32, rect.width,
+				rect.height, stride);
+		if(cairo_surface_status(buffer->surface)
+				!= CAIRO_STATUS_SUCCESS)
+		{
+			_locker_demo_release(locker, buffer);
+			return NULL;
+		}
+		/* the memory may come from any other frame */
+		buffer->age = 0;
+		buffer->exposed = TRUE;
+	}
+	/* split the frame in rows of tiles fitting in the caches */
+	rows = LOCKER_DEMO_TILE / cairo_image_surface_get_stride(
+			buffer->surface);
+	rows = max(rows, 1);
+	cnt = (rect.height + rows - 1) / rows;
+	if(cnt != buffer->tiles_cnt)
+	{
+		if((tile = realloc(buffer->tiles, sizeof(*tile) * cnt)) == NULL)
+			return NULL;
+		buffer->tiles = tile;
+		buffer->tiles_cnt = cnt;
+	}
+	for(j = 0; j < buffer->tiles_cnt; j++)
+	{
+		tile = &buffer->tiles[j];
+		tile->buffer = i;
+		tile->clip.x = 0;
+		tile->clip.y = j * rows;
+		tile->clip.width = rect.width;
+		tile->clip.height = min(rows, rect.height - tile->clip.y);
+		tile->ret = -1;
+		tile->damage_cnt = 0;
+	}
+	cairo_surface_flush(buffer->surface);
+	buffer->rect = rect;
+	return buffer;
+}
+
+
+/* locker_demo_present */
+static gboolean _present_tile(LockerDemoTile const * tile, cairo_t * cairo,
+		int margin);
+
+static int _locker_demo_present(Locker * locker, size_t i)
+{
+	LockerDemoBuffer * buffer = &locker->dm_buffers[i];
+	LockerDemoBuffer * frame = &locker->dm_buffers[buffer->frame];
+	GdkWindow * window;
+	cairo_t * cairo;
+	int ret = -1;
+	size_t j;
+
+	if(locker->windows[i] == NULL)
+		return -1;
+	/* every tile must have been rendered */
+	for(j = 0; j < frame->tiles_cnt; j++)
+		ret = (j == 0) ? frame->tiles[j].ret
+			: min(ret, frame->tiles[j].ret);
+	if(ret < 0)
+		return -1;
+#if GTK_CHECK_VERSION(2, 14, 0)
+	if((window = gtk_widget_get_window(locker->windows[i])) == NULL)
+#else
+	if((window = locker->windows[i]->window) == NULL)
+#endif
+		return -1;
+	cairo_surface_mark_dirty(frame->surface);
+	/* present the frame, or only the areas damaged if reported */
+	if(!buffer->exposed)
+	{
+		for(j = 0; j < frame->tiles_cnt; j++)
+			if(_present_tile(&frame->tiles[j], NULL, 0))
+				break;
+		if(j == frame->tiles_cnt)
+			/* nothing changed */
+			return ret;
+	}
+	cairo = gdk_cairo_create(window);
+	/* scale the frame up while presenting it (on the server if possible) */
+	if(locker->dm_scale > 1)
+		cairo_scale(cairo, locker->dm_scale, locker->dm_scale);
+	if(!buffer->exposed)
+	{
+		/* filtering also changes the pixels around the areas damaged */
+		for(j = 0; j < frame->tiles_cnt; j++)
+			_present_tile(&frame->tiles[j], cairo,
+					(locker->dm_scale > 1) ? 1 : 0);
+		cairo_clip(cairo);
+	}
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface(cairo, frame->surface, 0.0, 0.0);
+	if(locker->dm_scale > 1)
+	{
+		cairo_pattern_set_filter(cairo_get_source(cairo),
+				CAIRO_FILTER_BILINEAR);
+		cairo_pattern_set_extend(cairo_get_source(cairo),
+				CAIRO_EXTEND_PAD);
+	}
+	cairo_paint(cairo);
+	cairo_destroy(cairo);
+	buffer->exposed = FALSE;
+	return ret;
+}
+
+static gboolean _present_tile(LockerDemoTile const * tile, cairo_t * cairo,
+		int margin)
+{
+	gboolean ret = FALSE;
+	GdkRectangle area;
+	size_t i;
+
+	/* the whole tile changed unless the areas damaged were reported */
+	if(tile->damage_cnt == 0 || tile->damage_cnt > LOCKER_DEMO_DAMAGE)
+	{
+		if(cairo != NULL)
+			gdk_cairo_rectangle(cairo, &tile->clip);
+		return TRUE;
+	}
+	for(i = 0; i < tile->damage_cnt; i++)
+		if(gdk_rectangle_intersect(&tile->damage[i], &tile->clip,
+					&area))
+		{
+			if(cairo == NULL)
+				return TRUE;
+			cairo_rectangle(cairo, area.x - margin, area.y - margin,
+					area.width + margin * 2,
+					area.height + margin * 2);
+			ret = TRUE;
+		}
+	return ret;
+}
+
+
+/* locker_demo_refresh */
+static void _locker_demo_refresh(Locker * locker)
+{
+	/* render again on the next frame if idle */
+	if(locker->dm_source == 0)
+		return;
+	g_source_remove(locker->dm_source);
+	locker->dm_source = 0;
+	locker->dm_frame = _locker_frame_add(locker, LOCKER_DEMO_RATE,
+			_locker_on_demo_frame, locker);
+}
+
+
+/* locker_demo_release */
+static void _locker_demo_release(Locker * locker, LockerDemoBuffer * buffer)
+{
+	LockerDemoMemory * m;
+	char const * p;
+	int delay = LOCKER_DEMO_TRIM;
+
+	if(buffer->surface != NULL)
+		cairo_surface_destroy(buffer->surface);
+	buffer->surface = NULL;
+	if(buffer->data == NULL)
+		return;
+	/* keep the memory around for a while, unless configured otherwise */
+	if((p = config_get(locker->config, NULL, "demo_trim")) != NULL)
+		delay = strtol(p, NULL, 10);
+	if(delay <= 0 || (m = realloc(locker->dm_memory, sizeof(*m)
+					* (locker->dm_memory_cnt + 1))) == NULL)
+		munmap(buffer->data, buffer->size);
+	else
+	{
+		locker->dm_memory = m;
+		m = &locker->dm_memory[locker->dm_memory_cnt++];
+		m->data = buffer->data;
+		m->size = buffer->size;
+		m->expires = g_get_monotonic_time()
+			+ (gint64)delay * G_USEC_PER_SEC;
+		if(locker->dm_trim == 0)
+			locker->dm_trim = g_timeout_add_seconds(delay,
+					_locker_on_demo_trim, locker);
+	}
+	buffer->data = NULL;
+	buffer->size = 0;
+}
+
+
 /* locker_demo_reload */
 static void _locker_demo_reload(Locker * locker)
 {
+	size_t i;
+
 	if(locker->ddefinition != NULL && locker->ddefinition->reload != NULL)
+	{
+		_locker_demo_wait(locker);
+		_locker_demo_scale(locker);
 		locker->ddefinition->reload(locker->demo);
+		/* the frames rendered may not match the configuration */
+		for(i = 0; i < locker->dm_buffers_cnt; i++)
+			locker->dm_buffers[i].age = 0;
+		_locker_demo_refresh(locker);
+	}
+}
+
+
+/* locker_demo_render */
+static void _locker_demo_render(Locker * locker, LockerDemoTile * tile)
+{
+	LockerDemoBuffer * buffer = &locker->dm_buffers[tile->buffer];
+
+	/* may be called from any thread */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	g_private_set(&_locker_demo_tile, tile);
+#else
+	if(_locker_demo_tile != NULL)
+		g_private_set(_locker_demo_tile, tile);
+#endif
+	tile->ret = locker->ddefinition->render(locker->demo,
+			cairo_image_surface_get_data(buffer->surface),
+			cairo_image_surface_get_stride(buffer->surface),
+			&buffer->rect, &tile->clip, locker->dm_elapsed);
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	g_private_set(&_locker_demo_tile, NULL);
+#else
+	if(_locker_demo_tile != NULL)
+		g_private_set(_locker_demo_tile, NULL);
+#endif
+}
+
+
+/* locker_demo_scale */
+static void _locker_demo_scale(Locker * locker)
+{
+	LockerConfigSection * section;
+	char const * p;
+	int scale;
+
+	/* render_scale divides the resolution of the frames rendered */
+	locker->dm_scale = 1;
+	section = _locker_demo_config_section(locker, locker->dname);
+	if((p = _locker_config_section_get(locker, section, "render_scale"))
+			== NULL)
+		return;
+	scale = strtol(p, NULL, 10);
+	if(scale >= 1 && scale <= LOCKER_DEMO_SCALE)
+		locker->dm_scale = scale;
 }
 
 
 /* locker_demo_start */
 static void _locker_demo_start(Locker * locker)
 {
-	if(locker->ddefinition != NULL && locker->ddefinition->start != NULL)
+	if(locker->ddefinition == NULL)
+		return;
+	locker->fr_start = g_get_monotonic_time();
+	if(locker->ddefinition->start != NULL)
 		locker->ddefinition->start(locker->demo);
+	/* render on behalf of the demo */
+	_locker_demo_scale(locker);
+	if(locker->ddefinition->render != NULL && locker->dm_pool == NULL)
+		_locker_demo_pool(locker);
+	if(locker->ddefinition->render != NULL && locker->dm_frame == 0
+			&& locker->dm_source == 0)
+		locker->dm_frame = _locker_frame_add(locker, LOCKER_DEMO_RATE,
+				_locker_on_demo_frame, locker);
+	_locker_control_event(locker, "demo-start", -1, locker->dname);
 }
 
 
 /* locker_demo_stop */
 static void _locker_demo_stop(Locker * locker)
 {
+	size_t i;
 #if GTK_CHECK_VERSION(2, 14, 0) && !GTK_CHECK_VERSION(3, 0, 0)
 	GdkWindow * window;
 #endif
 
-	if(locker->ddefinition != NULL && locker->ddefinition->stop != NULL)
-		locker->ddefinition->stop(locker->demo);
+	if(locker->dm_frame != 0)
+		_locker_frame_remove(locker, locker->dm_frame);
+	locker->dm_frame = 0;
+	if(locker->dm_source != 0)
+		g_source_remove(locker->dm_source);
+	locker->dm_source = 0;
+	_locker_demo_wait(locker);
+	/* hand the frames back until started again */
+	for(i = 0; i < locker->dm_buffers_cnt; i++)
+		_locker_demo_release(locker, &locker->dm_buffers[i]);
+	if(locker->ddefinition != NULL)
+	{
+		if(locker->ddefinition->stop != NULL)
+			locker->ddefinition->stop(locker->demo);
+		_locker_control_event(locker, "demo-stop", -1, locker->dname);
+	}
 #if GTK_CHECK_VERSION(2, 14, 0) && !GTK_CHECK_VERSION(3, 0, 0)
 	if(locker->windows[0] != NULL
 			&& (window = gtk_widget_get_window(locker->windows[0]))
@@ -1798,12 +3427,61 @@ static void _locker_demo_stop(Locker * locker)
 }
 
 
+/* locker_demo_trim */
+static void _locker_demo_trim(Locker * locker, gboolean all)
+{
+	gint64 now = g_get_monotonic_time();
+	size_t i;
+	size_t j;
+
+	/* return the memory of the frames unused for long to the system */
+	for(i = 0, j = 0; i < locker->dm_memory_cnt; i++)
+		if(all || locker->dm_memory[i].expires <= now)
+			munmap(locker->dm_memory[i].data,
+					locker->dm_memory[i].size);
+		else
+			locker->dm_memory[j++] = locker->dm_memory[i];
+	locker->dm_memory_cnt = j;
+	if(j > 0)
+		return;
+	free(locker->dm_memory);
+	locker->dm_memory = NULL;
+	if(locker->dm_trim != 0)
+		g_source_remove(locker->dm_trim);
+	locker->dm_trim = 0;
+}
+
+
 /* locker_demo_unload */
 static void _locker_demo_unload(Locker * locker)
 {
 	size_t i;
 	GdkWindow * window;
 
+	string_delete(locker->dname);
+	locker->dname = NULL;
+	/* stop rendering on behalf of the demo */
+	if(locker->dm_frame != 0)
+		_locker_frame_remove(locker, locker->dm_frame);
+	locker->dm_frame = 0;
+	if(locker->dm_source != 0)
+		g_source_remove(locker->dm_source);
+	locker->dm_source = 0;
+	_locker_demo_wait(locker);
+	if(locker->dm_pool != NULL)
+		g_thread_pool_free(locker->dm_pool, FALSE, TRUE);
+	locker->dm_pool = NULL;
+	if(locker->dm_done != NULL)
+		g_async_queue_unref(locker->dm_done);
+	locker->dm_done = NULL;
+	for(i = 0; i < locker->dm_buffers_cnt; i++)
+	{
+		_locker_demo_release(locker, &locker->dm_buffers[i]);
+		free(locker->dm_buffers[i].tiles);
+	}
+	free(locker->dm_buffers);
+	locker->dm_buffers = NULL;
+	locker->dm_buffers_cnt = 0;
 	if(locker->demo == NULL)
 		return;
 	if(locker->ddefinition != NULL && locker->ddefinition->remove != NULL)
@@ -1825,6 +3503,28 @@ static void _locker_demo_unload(Locker * locker)
 }
 
 
+/* locker_demo_wait */
+static void _locker_demo_wait(Locker * locker)
+{
+	size_t i;
+	guint source;
+
+	/* wait for the frames still rendering, and drop them */
+	for(; locker->dm_jobs > 0; locker->dm_jobs--)
+		g_async_queue_pop(locker->dm_done);
+	if((source = g_atomic_int_get(&locker->dm_present)) != 0)
+		g_source_remove(source);
+	g_atomic_int_set(&locker->dm_present, 0);
+	for(i = 0; i < locker->dm_buffers_cnt; i++)
+		if(locker->dm_buffers[i].pending)
+		{
+			/* the buffer and the window now differ */
+			locker->dm_buffers[i].pending = FALSE;
+			locker->dm_buffers[i].exposed = TRUE;
+		}
+}
+
+
 /* locker_disable */
 static void _locker_disable(Locker * locker)
 {
@@ -1869,23 +3569,440 @@ static int _locker_event(Locker * locker, LockerEvent event)
 {
 	int ret = 0;
 	size_t i;
-	LockerPluginDefinition * lpd;
-	LockerPlugin * lp;
+	LockerPlugins * lp;
+	gboolean failed = FALSE;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%u)\n", __func__, event);
 #endif
-	for(i = 0; i < locker->plugins_cnt; i++)
+	switch(event)
 	{
-		lpd = locker->plugins[i].definition;
-		lp = locker->plugins[i].plugin;
-		if(lpd->event != NULL)
-			ret |= lpd->event(lp, event);
+		case LOCKER_EVENT_AUTH_FAILED:
+			_locker_control_event(locker, _locker_events[event], -1,
+					locker->aname);
+			break;
+		case LOCKER_EVENT_CYCLING:
+		case LOCKER_EVENT_CYCLED:
+			_locker_control_event(locker, _locker_events[event], -1,
+					locker->dname);
+			break;
+		default:
+			_locker_control_event(locker, _locker_events[event], -1,
+					NULL);
+			break;
+	}
+	for(i = 0; i < locker->pl_events_cnt[event]; i++)
+	{
+		lp = &locker->plugins[locker->pl_events[event][i]];
+		/* initialize plug-ins loaded on demand */
+		if(lp->plugin == NULL && _locker_plugin_init(locker, lp) != 0)
+		{
+			/* do not try again for the next events */
+			lp->events = 0;
+			failed = TRUE;
+			continue;
+		}
+		ret |= lp->definition->event(lp->plugin, event);
 	}
+	if(failed)
+		_locker_plugin_dispatch(locker);
 	return (ret == 0) ? 0 : -1;
 }
 
 
+/* frames */
+/* locker_frame_add */
+static guint _locker_frame_add(Locker * locker, unsigned int fps,
+		LockerDemoFrameFunc func, gpointer data)
+{
+	LockerFrame * p;
+
+	if(func == NULL)
+		return 0;
+	if((p = realloc(locker->fr_frames, sizeof(*p)
+					* (locker->fr_frames_cnt + 1))) == NULL)
+	{
+		_locker_error(NULL, strerror(errno), 1);
+		return 0;
+	}
+	locker->fr_frames = p;
+	p = &locker->fr_frames[locker->fr_frames_cnt++];
+	/* 0 is never a valid identifier */
+	if(++locker->fr_id == 0)
+		locker->fr_id++;
+	p->id = locker->fr_id;
+	p->fps = fps;
+	p->func = func;
+	p->data = data;
+	p->next = 0;
+	_locker_frame_start(locker);
+	return p->id;
+}
+
+
+/* locker_frame_age */
+static int _locker_frame_age(Locker * locker)
+{
+	LockerDemoTile * tile;
+
+	/* only while rendering on behalf of the demo, from any thread */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	if((tile = g_private_get(&_locker_demo_tile)) == NULL)
+#else
+	if(_locker_demo_tile == NULL
+			|| (tile = g_private_get(_locker_demo_tile)) == NULL)
+#endif
+		return 0;
+	return locker->dm_buffers[tile->buffer].age;
+}
+
+
+/* locker_frame_compact */
+static void _locker_frame_compact(Locker * locker)
+{
+	size_t i;
+	size_t j;
+
+	for(i = 0, j = 0; i < locker->fr_frames_cnt; i++)
+		if(locker->fr_frames[i].func != NULL)
+			locker->fr_frames[j++] = locker->fr_frames[i];
+	locker->fr_frames_cnt = j;
+	if(j == 0)
+		_locker_frame_stop(locker);
+}
+
+
+/* locker_frame_damage */
+static void _locker_frame_damage(Locker * locker, GdkRectangle const * area)
+{
+	LockerDemoTile * tile;
+	(void) locker;
+
+	/* only while rendering on behalf of the demo, from any thread */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	if((tile = g_private_get(&_locker_demo_tile)) == NULL)
+#else
+	if(_locker_demo_tile == NULL
+			|| (tile = g_private_get(_locker_demo_tile)) == NULL)
+#endif
+		return;
+	if(tile->damage_cnt < LOCKER_DEMO_DAMAGE)
+		tile->damage[tile->damage_cnt] = *area;
+	/* too many areas are presented as a whole */
+	if(tile->damage_cnt <= LOCKER_DEMO_DAMAGE)
+		tile->damage_cnt++;
+}
+
+
+/* locker_frame_deadline */
+static gint64 _locker_frame_deadline(Locker * locker)
+{
+	if(locker->fr_dispatching)
+		return locker->fr_deadline;
+	return g_get_monotonic_time() + G_USEC_PER_SEC / LOCKER_FRAME_RATE;
+}
+
+
+/* locker_frame_dispatch */
+static void _locker_frame_dispatch(Locker * locker, gint64 time,
+		gint64 deadline)
+{
+	size_t i;
+	LockerFrame * f;
+	gint64 period;
+
+	locker->fr_dispatching = TRUE;
+	locker->fr_current = time;
+	locker->fr_deadline = deadline;
+	/* the callbacks may add frames, but only mark those removed */
+	for(i = 0; i < locker->fr_frames_cnt; i++)
+	{
+		f = &locker->fr_frames[i];
+		if(f->func == NULL)
+			continue;
+		if(f->fps != 0)
+		{
+			if(time + LOCKER_FRAME_SLACK < f->next)
+				continue;
+			/* stay on schedule, without catching up */
+			period = G_USEC_PER_SEC / f->fps;
+			f->next = (f->next + period > time) ? f->next + period
+				: time + period;
+		}
+		if(f->func(time, f->data) == FALSE)
+			locker->fr_frames[i].func = NULL;
+	}
+	locker->fr_dispatching = FALSE;
+	_locker_frame_compact(locker);
+}
+
+
+/* locker_frame_elapsed */
+static gint64 _locker_frame_elapsed(Locker * locker)
+{
+	gint64 time;
+
+	/* the same for every demo rendering the current frame */
+	time = locker->fr_dispatching ? locker->fr_current
+		: g_get_monotonic_time();
+	return max(time - locker->fr_start, 0);
+}
+
+
+/* locker_frame_rate */
+static unsigned int _locker_frame_rate(Locker * locker)
+{
+	unsigned int ret = 0;
+	size_t i;
+
+	/* the highest rate requested */
+	for(i = 0; i < locker->fr_frames_cnt; i++)
+		if(locker->fr_frames[i].fps == 0)
+			return LOCKER_FRAME_RATE;
+		else
+			ret = max(ret, locker->fr_frames[i].fps);
+	return (ret != 0) ? min(ret, LOCKER_FRAME_RATE) : LOCKER_FRAME_RATE;
+}
+
+
+/* locker_frame_remove */
+static void _locker_frame_remove(Locker * locker, guint id)
+{
+	size_t i;
+
+	for(i = 0; i < locker->fr_frames_cnt; i++)
+		if(locker->fr_frames[i].id == id)
+		{
+			locker->fr_frames[i].func = NULL;
+			break;
+		}
+	if(locker->fr_dispatching == FALSE)
+		_locker_frame_compact(locker);
+}
+
+
+/* locker_frame_start */
+static void _locker_frame_start(Locker * locker)
+{
+#if GTK_CHECK_VERSION(3, 8, 0)
+	size_t i;
+	GdkWindow * window;
+	GdkFrameClock * clock;
+#endif
+
+	if(locker->fr_source != 0)
+		return;
+#if GTK_CHECK_VERSION(3, 8, 0)
+	if(locker->fr_clock != NULL)
+		return;
+	/* follow the refresh of the primary monitor */
+	i = _locker_get_primary_monitor(locker);
+	if(locker->windows != NULL && locker->windows[i] != NULL
+			&& (window = gtk_widget_get_window(locker->windows[i]))
+			!= NULL
+			&& (clock = gdk_window_get_frame_clock(window)) != NULL)
+	{
+		locker->fr_clock = g_object_ref(clock);
+		locker->fr_handler = g_signal_connect(clock, "update",
+				G_CALLBACK(_locker_on_frame_update), locker);
+		gdk_frame_clock_begin_updating(clock);
+		return;
+	}
+#endif
+	/* pace the frames with a timer instead */
+	locker->fr_time = g_get_monotonic_time();
+	locker->fr_source = g_idle_add(_locker_on_frame_timeout, locker);
+}
+
+
+/* locker_frame_stop */
+static void _locker_frame_stop(Locker * locker)
+{
+#if GTK_CHECK_VERSION(3, 8, 0)
+	if(locker->fr_clock != NULL)
+	{
+		gdk_frame_clock_end_updating(locker->fr_clock);
+		g_signal_handler_disconnect(locker->fr_clock,
+				locker->fr_handler);
+		g_object_unref(locker->fr_clock);
+		locker->fr_clock = NULL;
+		locker->fr_handler = 0;
+	}
+#endif
+	if(locker->fr_source != 0)
+		g_source_remove(locker->fr_source);
+	locker->fr_source = 0;
+}
+
+
+/* latency */
+/* locker_latency_cancel */
+static void _locker_latency_cancel(Locker * locker)
+{
+	/* the screen was not locked as expected */
+	if(locker->lt_stages[LLS_TRIGGER] != 0)
+		_locker_control_locked(locker, LOCKER_CONTROL_STATUS_ERROR);
+	memset(locker->lt_stages, 0, sizeof(locker->lt_stages));
+}
+
+
+/* locker_latency_report */
+static String * _locker_latency_report(Locker * locker)
+{
+	String * s;
+	LockerLatency * latency;
+	char buf[128];
+	size_t i;
+	size_t j;
+	int res = 0;
+
+	if((s = string_new("")) == NULL)
+		return NULL;
+	for(i = LLS_TRIGGER + 1; i < LLS_COUNT; i++)
+	{
+		latency = &locker->lt_stats[i];
+		snprintf(buf, sizeof(buf), "%s: count=%lu min=%.3fms"
+				" avg=%.3fms max=%.3fms",
+				_locker_latency_stages[i], latency->count,
+				latency->min / 1000.0, (latency->count > 0)
+				? latency->total / 1000.0 / latency->count
+				: 0.0, latency->max / 1000.0);
+		res |= string_append(&s, buf);
+		for(j = 0; j < LOCKER_LATENCY_BUCKETS; j++)
+		{
+			if(latency->buckets[j] == 0)
+				continue;
+			if(j < LOCKER_LATENCY_BUCKETS - 1)
+				snprintf(buf, sizeof(buf), " <%lums:%lu",
+						1UL << j, latency->buckets[j]);
+			else
+				snprintf(buf, sizeof(buf), " >=%lums:%lu",
+						1UL << (j - 1),
+						latency->buckets[j]);
+			res |= string_append(&s, buf);
+		}
+		res |= string_append(&s, "\n");
+	}
+	if(res != 0)
+	{
+		string_delete(s);
+		return NULL;
+	}
+	return s;
+}
+
+
+/* locker_latency_stage */
+static void _latency_stage_record(LockerLatency * latency, gint64 value);
+
+static void _locker_latency_stage(Locker * locker, LockerLatencyStage stage)
+{
+	size_t i;
+
+	if(locker->lt_stages[LLS_TRIGGER] == 0 || locker->lt_stages[stage] != 0)
+		/* not measuring, or this stage was already reached */
+		return;
+	locker->lt_stages[stage] = g_get_monotonic_time();
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(\"%s\") %" G_GINT64_FORMAT "us\n", __func__,
+			_locker_latency_stages[stage], locker->lt_stages[stage]
+			- locker->lt_stages[LLS_TRIGGER]);
+#endif
+	for(i = 0; i < LLS_COUNT; i++)
+		if(locker->lt_stages[i] == 0)
+			/* the sequence is not complete yet */
+			return;
+	for(i = LLS_TRIGGER + 1; !locker->lt_visible && i < LLS_COUNT; i++)
+		_latency_stage_record(&locker->lt_stats[i], locker->lt_stages[i]
+				- locker->lt_stages[LLS_TRIGGER]);
+	_locker_control_locked(locker, LOCKER_CONTROL_STATUS_OK);
+	_locker_latency_cancel(locker);
+}
+
+static void _latency_stage_record(LockerLatency * latency, gint64 value)
+{
+	gint64 ms;
+	size_t i;
+
+	if(latency->count == 0 || value < latency->min)
+		latency->min = value;
+	if(latency->count == 0 || value > latency->max)
+		latency->max = value;
+	latency->count++;
+	latency->total += value;
+	for(i = 0, ms = value / 1000; ms > 0; ms >>= 1)
+		if(++i == LOCKER_LATENCY_BUCKETS - 1)
+			break;
+	latency->buckets[i]++;
+}
+
+
+/* locker_latency_start */
+static void _locker_latency_start(Locker * locker)
+{
+	size_t i;
+	gboolean mapped;
+
+	/* restart the measurement, any client still waiting keeps waiting */
+	memset(locker->lt_stages, 0, sizeof(locker->lt_stages));
+	locker->lt_stages[LLS_TRIGGER] = g_get_monotonic_time();
+	for(i = 0; i < locker->windows_cnt; i++)
+		if(locker->windows[i] != NULL)
+			g_object_set_data(G_OBJECT(locker->windows[i]),
+					"latency", NULL);
+	/* windows already visible are mapped and painted */
+	for(i = 0; i < locker->windows_cnt; i++)
+	{
+		if(locker->windows[i] == NULL)
+			continue;
+#if GTK_CHECK_VERSION(2, 20, 0)
+		mapped = gtk_widget_get_mapped(locker->windows[i]);
+#else
+		mapped = GTK_WIDGET_MAPPED(locker->windows[i]);
+#endif
+		if(mapped)
+		{
+			_locker_latency_window(locker, locker->windows[i],
+					LLS_MAPPED);
+			_locker_latency_window(locker, locker->windows[i],
+					LLS_PAINTED);
+		}
+	}
+	/* locking again does not tell how long it takes */
+	locker->lt_visible = (locker->lt_stages[LLS_MAPPED] != 0);
+	if(locker->grabbed)
+		_locker_latency_stage(locker, LLS_GRABBED);
+}
+
+
+/* locker_latency_window */
+static void _locker_latency_window(Locker * locker, GtkWidget * widget,
+		LockerLatencyStage stage)
+{
+	size_t i;
+	guint flags;
+
+	if(locker->lt_stages[LLS_TRIGGER] == 0 || locker->lt_stages[stage] != 0)
+		return;
+	flags = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget),
+				"latency"));
+	g_object_set_data(G_OBJECT(widget), "latency", GUINT_TO_POINTER(
+				flags | (1 << stage)));
+	/* wait until every window reached this stage */
+	for(i = 0; i < locker->windows_cnt; i++)
+	{
+		if(locker->windows[i] == NULL)
+			continue;
+		flags = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(
+						locker->windows[i]),
+					"latency"));
+		if((flags & (1 << stage)) == 0)
+			return;
+	}
+	_locker_latency_stage(locker, stage);
+}
+
+
 /* locker_lock */
 static int _locker_lock(Locker * locker, int force)
 {
@@ -1897,27 +4014,246 @@ static int _locker_lock(Locker * locker, int force)
 	if(force == 0 && _locker_event(locker, LOCKER_EVENT_LOCKING) != 0)
 		return -1;
 	locker->locked = TRUE;
+	locker->st_locked = g_get_monotonic_time();
+	locker->st_failed = 0;
 	_locker_activate(locker, 1);
 	if((ret = locker->adefinition->action(locker->auth, LOCKER_ACTION_LOCK))
 			== 0)
+	{
+		_locker_status_update(locker);
 		_locker_event(locker, LOCKER_EVENT_LOCKED);
+		_locker_latency_stage(locker, LLS_LOCKED);
+	}
+	else
+	{
+		/* the clients waiting are told right away */
+		_locker_control_locked(locker, LOCKER_CONTROL_STATUS_ERROR);
+		_locker_latency_cancel(locker);
+	}
+	return ret;
+}
+
+
+/* manifest */
+/* locker_manifest_entry */
+static String * _manifest_entry_path(char const * filename);
+static int _manifest_entry_update(Locker * locker, String const * path,
+		char const * type, char const * plugin, char const * mtime,
+		char const * size);
+
+static String * _locker_manifest_entry(Locker * locker, char const * type,
+		char const * plugin)
+{
+#ifdef __APPLE__
+	char const ext[] = ".dylib";
+#else
+	char const ext[] = ".so";
+#endif
+	String * path;
+	struct stat st;
+	char mtime[32];
+	char size[32];
+	char const * p;
+
+	if(locker->manifest == NULL)
+	{
+		if((locker->manifest = config_new()) == NULL)
+			return NULL;
+		/* ignore errors */
+		if((path = _manifest_entry_path(LOCKER_MANIFEST_FILE)) != NULL)
+			config_load(locker->manifest, path);
+		string_delete(path);
+	}
+	if((path = string_new_append(LIBDIR "/" PACKAGE "/", type, "/", plugin,
+					ext, NULL)) == NULL)
+		return NULL;
+	if(stat(path, &st) != 0)
+	{
+		string_delete(path);
+		return NULL;
+	}
+	/* entries are keyed by path, modification time and size */
+	snprintf(mtime, sizeof(mtime), "%ld", (long)st.st_mtime);
+	snprintf(size, sizeof(size), "%lld", (long long)st.st_size);
+	if((p = config_get(locker->manifest, path, "mtime")) == NULL
+			|| strcmp(p, mtime) != 0
+			|| (p = config_get(locker->manifest, path, "size"))
+			== NULL || strcmp(p, size) != 0)
+		if(_manifest_entry_update(locker, path, type, plugin, mtime,
+					size) != 0)
+		{
+			string_delete(path);
+			return NULL;
+		}
+	return path;
+}
+
+static String * _manifest_entry_path(char const * filename)
+{
+	String * ret;
+	char const * cache;
+	char const * homedir;
+
+	if((cache = getenv("XDG_CACHE_HOME")) != NULL && cache[0] == '/')
+		ret = string_new_append(cache, "/" LOCKER_CONFIG_VENDOR "/"
+				PACKAGE, NULL);
+	else if((homedir = getenv("HOME")) != NULL)
+		ret = string_new_append(homedir, "/.cache/"
+				LOCKER_CONFIG_VENDOR "/" PACKAGE, NULL);
+	else
+		return NULL;
+	if(ret != NULL && filename != NULL
+			&& (string_append(&ret, "/") != 0
+				|| string_append(&ret, filename) != 0))
+	{
+		string_delete(ret);
+		return NULL;
+	}
+	return ret;
+}
+
+static int _manifest_entry_update(Locker * locker, String const * path,
+		char const * type, char const * plugin, char const * mtime,
+		char const * size)
+{
+	int ret = 0;
+	Plugin * p;
+	void * definition;
+	LockerAuthDefinition * lad;
+	LockerDemoDefinition * ldd;
+	LockerPluginDefinition * lpd;
+	char const * name = NULL;
+	char const * icon = NULL;
+	char const * description = NULL;
+	char events[16] = "";
+	char flags[16] = "";
+	unsigned int e;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(\"%s\")\n", __func__, path);
+#endif
+	if((p = plugin_new(LIBDIR, PACKAGE, type, plugin)) == NULL)
+		return -1;
+	if((definition = plugin_lookup(p, "plugin")) == NULL)
+	{
+		plugin_delete(p);
+		return -1;
+	}
+	if(strcmp(type, "auth") == 0)
+	{
+		lad = definition;
+		name = lad->name;
+		icon = lad->icon;
+		description = lad->description;
+	}
+	else if(strcmp(type, "demos") == 0)
+	{
+		ldd = definition;
+		name = ldd->name;
+		icon = ldd->icon;
+		description = ldd->description;
+	}
+	else if(strcmp(type, "plugins") == 0)
+	{
+		lpd = definition;
+		name = lpd->name;
+		icon = lpd->icon;
+		description = lpd->description;
+		/* capabilities */
+		e = 0;
+		if(lpd->event != NULL)
+			e = (lpd->events != 0) ? lpd->events
+				: LOCKER_EVENT_MASK_ALL;
+		snprintf(events, sizeof(events), "%u", e);
+		snprintf(flags, sizeof(flags), "%u", lpd->flags);
+	}
+	if(name == NULL)
+		ret = -1;
+	else
+	{
+		ret |= config_set(locker->manifest, path, "name", name);
+		ret |= config_set(locker->manifest, path, "icon", icon);
+		ret |= config_set(locker->manifest, path, "description",
+				description);
+		ret |= config_set(locker->manifest, path, "events",
+				(events[0] != '\0') ? events : NULL);
+		ret |= config_set(locker->manifest, path, "flags",
+				(flags[0] != '\0') ? flags : NULL);
+		ret |= config_set(locker->manifest, path, "size", size);
+		/* set last, to be rebuilt on errors */
+		ret |= config_set(locker->manifest, path, "mtime",
+				(ret == 0) ? mtime : NULL);
+		locker->manifest_changed = TRUE;
+	}
+	plugin_delete(p);
+	return (ret == 0) ? 0 : -1;
+}
+
+
+/* locker_manifest_get */
+static char const * _locker_manifest_get(Locker * locker,
+		String const * entry, char const * variable)
+{
+	return config_get(locker->manifest, entry, variable);
+}
+
+
+/* locker_manifest_save */
+static int _locker_manifest_save(Locker * locker)
+{
+	int ret;
+	String * path;
+
+	if(locker->manifest == NULL || locker->manifest_changed == FALSE)
+		return 0;
+	if((path = _manifest_entry_path(NULL)) == NULL)
+		return -1;
+	/* create the cache directory as necessary */
+	_locker_mkdir(path);
+	string_delete(path);
+	if((path = _manifest_entry_path(LOCKER_MANIFEST_FILE)) == NULL)
+		return -1;
+	if((ret = config_save(locker->manifest, path)) == 0)
+		locker->manifest_changed = FALSE;
+	string_delete(path);
 	return ret;
 }
 
 
+/* locker_mkdir */
+static int _locker_mkdir(char * path)
+{
+	size_t i;
+	char c;
+
+	/* also create the parent directories */
+	for(i = 1; path[i - 1] != '\0'; i++)
+	{
+		if(path[i] != '/' && path[i] != '\0')
+			continue;
+		c = path[i];
+		path[i] = '\0';
+		if(mkdir(path, 0700) != 0 && errno != EEXIST)
+		{
+			path[i] = c;
+			return -1;
+		}
+		path[i] = c;
+	}
+	return 0;
+}
+
+
 /* plug-ins */
 /* locker_plugin_config_get */
 static char const * _locker_plugin_config_get(Locker * locker,
 		char const * section, char const * variable)
 {
-	char const * ret;
-	String * s;
+	LockerConfigSection * s;
 
-	if((s = string_new_append("plugin::", section, NULL)) == NULL)
+	if((s = _locker_config_section(locker, "plugin::", section)) == NULL)
 		return NULL;
-	ret = config_get(locker->config, s, variable);
-	string_delete(s);
-	return ret;
+	return config_get(locker->config, s->name, variable);
 }
 
 
@@ -1926,22 +4262,95 @@ static int _locker_plugin_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value)
 {
 	int ret;
-	String * s;
+	LockerConfigSection * s;
 
-	if((s = string_new_append("plugin::", section, NULL)) == NULL)
+	if((s = _locker_config_section(locker, "plugin::", section)) == NULL)
 		return -1;
-	ret = config_set(locker->config, s, variable, value);
-	string_delete(s);
-	if(ret == 0)
+	if((ret = config_set(locker->config, s->name, variable, value)) == 0)
 		ret = _locker_config_save(locker);
 	return ret;
 }
 
 
+/* locker_plugin_config_section */
+static LockerConfigSection * _locker_plugin_config_section(Locker * locker,
+		char const * section)
+{
+	return _locker_config_section(locker, "plugin::", section);
+}
+
+
+/* locker_plugin_dispatch */
+static int _locker_plugin_dispatch(Locker * locker)
+{
+	int ret = 0;
+	size_t e;
+	size_t i;
+	size_t * p;
+
+	for(e = 0; e < LOCKER_EVENT_COUNT; e++)
+	{
+		locker->pl_events_cnt[e] = 0;
+		if(locker->plugins_cnt == 0)
+		{
+			free(locker->pl_events[e]);
+			locker->pl_events[e] = NULL;
+			continue;
+		}
+		if((p = realloc(locker->pl_events[e], sizeof(*p)
+						* locker->plugins_cnt)) == NULL)
+		{
+			ret = -_locker_error(NULL, strerror(errno), 1);
+			continue;
+		}
+		locker->pl_events[e] = p;
+		for(i = 0; i < locker->plugins_cnt; i++)
+			if(locker->plugins[i].events & LOCKER_EVENT_MASK(e))
+				p[locker->pl_events_cnt[e]++] = i;
+	}
+	return ret;
+}
+
+
+/* locker_plugin_init */
+static int _locker_plugin_init(Locker * locker, LockerPlugins * plugin)
+{
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(\"%s\")\n", __func__, plugin->name);
+#endif
+	/* load plug-ins deferred through the manifest */
+	if(plugin->pplugin == NULL)
+	{
+		if((plugin->pplugin = plugin_new(LIBDIR, PACKAGE, "plugins",
+						plugin->name)) == NULL)
+			return -_locker_error(NULL, error_get(NULL), 1);
+		if((plugin->definition = plugin_lookup(plugin->pplugin,
+						"plugin")) == NULL
+				|| plugin->definition->init == NULL
+				|| plugin->definition->destroy == NULL
+				|| plugin->definition->event == NULL)
+		{
+			plugin_delete(plugin->pplugin);
+			plugin->pplugin = NULL;
+			plugin->definition = NULL;
+			return -_locker_error(NULL, error_get(NULL), 1);
+		}
+	}
+	if((plugin->plugin = plugin->definition->init(&locker->phelper))
+			== NULL)
+		return -_locker_error(NULL, error_get(NULL), 1);
+	return 0;
+}
+
+
 /* locker_plugin_load */
 static int _locker_plugin_load(Locker * locker, char const * plugin)
 {
 	LockerPlugins * p;
+	String * entry;
+	char const * q;
+	unsigned long flags = 0;
+	unsigned long events = 0;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(\"%s\")\n", __func__, plugin);
@@ -1953,6 +4362,26 @@ static int _locker_plugin_load(Locker * locker, char const * plugin)
 		return _locker_error(NULL, strerror(errno), 1);
 	locker->plugins = p;
 	p = &locker->plugins[locker->plugins_cnt];
+	/* do not even load the plug-ins requested on demand */
+	if((entry = _locker_manifest_entry(locker, "plugins", plugin)) != NULL)
+	{
+		flags = ((q = _locker_manifest_get(locker, entry, "flags"))
+				!= NULL) ? strtoul(q, NULL, 10) : 0;
+		events = ((q = _locker_manifest_get(locker, entry, "events"))
+				!= NULL) ? strtoul(q, NULL, 10) : 0;
+		string_delete(entry);
+	}
+	if((flags & LOCKER_PLUGIN_FLAG_ON_DEMAND) && events != 0)
+	{
+		if((p->name = strdup(plugin)) == NULL)
+			return _locker_error(NULL, strerror(errno), 1);
+		p->pplugin = NULL;
+		p->definition = NULL;
+		p->plugin = NULL;
+		p->events = events;
+		locker->plugins_cnt++;
+		return _locker_plugin_dispatch(locker);
+	}
 	if((p->pplugin = plugin_new(LIBDIR, PACKAGE, "plugins", plugin))
 			== NULL)
 		return _locker_error(NULL, error_get(NULL), 1);
@@ -1962,16 +4391,28 @@ static int _locker_plugin_load(Locker * locker, char const * plugin)
 		return _locker_error(NULL, error_get(NULL), 1);
 	}
 	p->name = strdup(plugin);
-	if(p->definition->init == NULL || p->definition->destroy == NULL
-			|| (p->plugin = p->definition->init(&locker->phelper))
-			== NULL)
+	p->plugin = NULL;
+	p->events = 0;
+	if(p->definition->event != NULL)
+		p->events = (p->definition->events != 0)
+			? p->definition->events : LOCKER_EVENT_MASK_ALL;
+	if(p->definition->init == NULL || p->definition->destroy == NULL)
 	{
 		free(p->name);
 		plugin_delete(p->pplugin);
 		return _locker_error(NULL, error_get(NULL), 1);
 	}
+	/* plug-ins loaded on demand are initialized on their first event */
+	if(((p->definition->flags & LOCKER_PLUGIN_FLAG_ON_DEMAND) == 0
+				|| p->events == 0)
+			&& _locker_plugin_init(locker, p) != 0)
+	{
+		free(p->name);
+		plugin_delete(p->pplugin);
+		return 1;
+	}
 	locker->plugins_cnt++;
-	return 0;
+	return _locker_plugin_dispatch(locker);
 }
 
 
@@ -1992,13 +4433,34 @@ static int _locker_plugin_unload(Locker * locker, char const * plugin)
 		return 0;
 	/* unload the plug-in */
 	lp = &locker->plugins[i];
-	if(lp->definition->destroy != NULL)
+	if(lp->plugin != NULL && lp->definition->destroy != NULL)
 		lp->definition->destroy(lp->plugin);
-	plugin_delete(lp->pplugin);
+	if(lp->pplugin != NULL)
+		plugin_delete(lp->pplugin);
 	free(lp->name);
 	memmove(lp, &lp[1], sizeof(*lp) * (--locker->plugins_cnt - i));
 	/* FIXME should call realloc() to gain some memory */
-	return 0;
+	return _locker_plugin_dispatch(locker);
+}
+
+
+/* status */
+/* locker_status_update */
+static void _locker_status_update(Locker * locker)
+{
+	LockerStatus * status = locker->st_status;
+
+	if(status == NULL)
+		return;
+	/* the sequence is odd while updating, with full memory barriers */
+	g_atomic_int_inc((gint *)&status->sequence);
+	status->flags = (locker->active ? LOCKER_STATUS_FLAG_ACTIVE : 0)
+		| (locker->locked ? LOCKER_STATUS_FLAG_LOCKED : 0);
+	status->locked = locker->st_locked;
+	status->failed = locker->st_failed;
+	snprintf(status->demo, sizeof(status->demo), "%s",
+			(locker->dname != NULL) ? locker->dname : "");
+	g_atomic_int_inc((gint *)&status->sequence);
 }
 
 
@@ -2023,6 +4485,12 @@ static int _locker_unlock(Locker * locker, int force)
 		return -1;
 	_locker_event(locker, LOCKER_EVENT_UNLOCKED);
 	locker->locked = FALSE;
+	_locker_status_update(locker);
+	_locker_latency_cancel(locker);
+	/* reload the authentication plug-in once out of its callbacks */
+	if(locker->cw_auth && locker->cw_timeout == 0)
+		locker->cw_timeout = g_idle_add(_locker_on_config_reload,
+				locker);
 	/* ungrab keyboard and mouse */
 	if(locker->windows == NULL)
 		return 0;
@@ -2039,6 +4507,7 @@ static int _locker_unlock(Locker * locker, int force)
 	gdk_keyboard_ungrab(GDK_CURRENT_TIME);
 	gdk_pointer_ungrab(GDK_CURRENT_TIME);
 #endif
+	locker->grabbed = FALSE;
 	for(i = 0; i < locker->windows_cnt; i++)
 		gtk_widget_hide(locker->windows[i]);
 	return 0;
@@ -2081,6 +4550,13 @@ static void _locker_window_register(Locker * locker, size_t i)
 				_locker_on_configure), locker);
 	g_signal_connect_swapped(locker->windows[i], "delete-event",
 			G_CALLBACK(_locker_on_closex), NULL);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	g_signal_connect_after(locker->windows[i], "draw", G_CALLBACK(
+				_locker_on_draw), locker);
+#else
+	g_signal_connect_after(locker->windows[i], "expose-event", G_CALLBACK(
+				_locker_on_expose_event), locker);
+#endif
 	/* automatically grab keyboard and mouse */
 	g_signal_connect(locker->windows[i], "map-event", G_CALLBACK(
 				_locker_on_map_event), locker);
@@ -2144,6 +4620,145 @@ static gboolean _locker_on_closex(void)
 }
 
 
+/* locker_on_config_changed */
+static gboolean _locker_on_config_changed(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+#if defined(__linux__)
+	Locker * locker = data;
+	char buf[4096]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event const * event;
+	ssize_t len;
+	char * p;
+	gboolean changed = FALSE;
+	(void) channel;
+	(void) condition;
+
+	while((len = read(locker->cw_fd, buf, sizeof(buf))) > 0)
+		for(p = buf; p < buf + len; p += sizeof(*event) + event->len)
+		{
+			event = (struct inotify_event const *)p;
+			if(event->len > 0 && strcmp(event->name,
+						LOCKER_CONFIG_FILE) == 0)
+				changed = TRUE;
+		}
+	if(len < 0 && errno != EAGAIN && errno != EINTR)
+	{
+		/* stop watching */
+		locker->cw_source = 0;
+		return FALSE;
+	}
+	/* coalesce the changes */
+	if(changed && locker->cw_timeout == 0)
+		locker->cw_timeout = g_timeout_add(LOCKER_CONFIG_DELAY,
+				_locker_on_config_reload, locker);
+	return TRUE;
+#else
+	(void) channel;
+	(void) condition;
+	(void) data;
+
+	return FALSE;
+#endif
+}
+
+
+/* locker_on_config_reload */
+static gboolean _locker_on_config_reload(gpointer data)
+{
+	Locker * locker = data;
+
+	if(locker->cf_source != 0 || g_atomic_int_get(&locker->cf_writing))
+		/* wait for the pending changes to be written first */
+		return TRUE;
+	locker->cw_timeout = 0;
+	_locker_config_reload(locker);
+	return FALSE;
+}
+
+
+/* locker_on_config_save */
+static gboolean _locker_on_config_save(gpointer data)
+{
+	Locker * locker = data;
+	LockerConfigWrite * lcw;
+
+	if(g_atomic_int_get(&locker->cf_writing))
+		/* the previous write is still in progress */
+		return TRUE;
+	locker->cf_source = 0;
+	if(locker->cf_thread != NULL)
+		g_thread_join(locker->cf_thread);
+	locker->cf_thread = NULL;
+	if((lcw = _config_flush_new(locker)) == NULL)
+	{
+		_locker_error(NULL, error_get(NULL), 1);
+		return FALSE;
+	}
+	g_atomic_int_set(&locker->cf_writing, 1);
+#if GLIB_CHECK_VERSION(2, 32, 0)
+	locker->cf_thread = g_thread_try_new("config", _locker_on_config_write,
+			lcw, NULL);
+#else
+	locker->cf_thread = g_thread_create(_locker_on_config_write, lcw, TRUE,
+			NULL);
+#endif
+	if(locker->cf_thread == NULL)
+		/* write synchronously instead */
+		_locker_on_config_write(lcw);
+	return FALSE;
+}
+
+
+/* locker_on_config_write */
+static gpointer _locker_on_config_write(gpointer data)
+{
+	LockerConfigWrite * lcw = data;
+	int ret = 0;
+	int fd;
+	int e = 0;
+
+	/* runs in a separate thread: do not use Gtk+ or the configuration */
+	if((fd = open(lcw->temporary, O_WRONLY)) < 0)
+	{
+		e = errno;
+		ret = -1;
+		unlink(lcw->temporary);
+	}
+	else
+	{
+		if(fsync(fd) != 0)
+		{
+			e = errno;
+			ret = -1;
+		}
+		if(close(fd) != 0 && ret == 0)
+		{
+			e = errno;
+			ret = -1;
+		}
+		/* replace the configuration file atomically */
+		if(ret == 0 && rename(lcw->temporary, lcw->filename) != 0)
+		{
+			e = errno;
+			ret = -1;
+		}
+		if(ret != 0)
+			unlink(lcw->temporary);
+	}
+	if(ret != 0)
+		fprintf(stderr, "%s: %s: %s\n", PROGNAME_LOCKER, lcw->filename,
+				strerror(e));
+	g_atomic_int_set(lcw->writing, 0);
+	string_delete(lcw->directory);
+	string_delete(lcw->filename);
+	string_delete(lcw->temporary);
+	object_delete(lcw);
+	return (ret == 0) ? NULL : GINT_TO_POINTER(ret);
+}
+
+
 /* locker_on_configure */
 static gboolean _locker_on_configure(GtkWidget * widget, GdkEvent * event,
 		gpointer data)
@@ -2181,6 +4796,287 @@ static gboolean _locker_on_configure(GtkWidget * widget, GdkEvent * event,
 }
 
 
+/* locker_on_control */
+static gboolean _locker_on_control(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	Locker * locker = data;
+	LockerControlClient ** p;
+	LockerControlClient * client;
+	int fd;
+	(void) channel;
+	(void) condition;
+
+	if((fd = accept(locker->ct_fd, NULL, NULL)) < 0)
+		return TRUE;
+	/* never block on the clients, even when replying */
+	if(fcntl(fd, F_SETFD, FD_CLOEXEC) != 0
+			|| fcntl(fd, F_SETFL, O_NONBLOCK) != 0
+			|| (client = object_new(sizeof(*client))) == NULL)
+	{
+		close(fd);
+		return TRUE;
+	}
+	if((p = realloc(locker->ct_clients, sizeof(*p)
+				* (locker->ct_clients_cnt + 1))) == NULL)
+	{
+		object_delete(client);
+		close(fd);
+		return TRUE;
+	}
+	locker->ct_clients = p;
+	client->locker = locker;
+	client->fd = fd;
+	client->request_cnt = 0;
+	client->wait = FALSE;
+	client->replied = FALSE;
+	client->subscribed = FALSE;
+	client->channel = g_io_channel_unix_new(fd);
+	client->source = g_io_add_watch(client->channel,
+			G_IO_IN | G_IO_ERR | G_IO_HUP,
+			_locker_on_control_client, client);
+	locker->ct_clients[locker->ct_clients_cnt++] = client;
+	return TRUE;
+}
+
+
+/* locker_on_control_client */
+static gboolean _locker_on_control_client(GIOChannel * channel,
+		GIOCondition condition, gpointer data)
+{
+	LockerControlClient * client = data;
+	Locker * locker = client->locker;
+	LockerControlMessage * request = &client->request;
+	char * p = (char *)request;
+	ssize_t s;
+	int res;
+	int ret;
+	gboolean wait;
+	String * report;
+	(void) channel;
+	(void) condition;
+
+	if((s = read(client->fd, &p[client->request_cnt], sizeof(*request)
+					- client->request_cnt)) < 0
+			&& (errno == EINTR || errno == EAGAIN
+				|| errno == EWOULDBLOCK))
+		return TRUE;
+	if(s <= 0)
+	{
+		/* the connection was closed */
+		client->source = 0;
+		_locker_control_close(locker, client);
+		return FALSE;
+	}
+	if((client->request_cnt += s) < sizeof(*request))
+		return TRUE;
+	client->request_cnt = 0;
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s() id=%u command=%u action=%u\n", __func__,
+			request->id, request->command, request->action);
+#endif
+	if(request->length != 0)
+	{
+		/* requests do not carry any data */
+		_locker_control_reply(client, LOCKER_CONTROL_STATUS_INVALID,
+				NULL, 0);
+		res = -1;
+	}
+	else if(request->command == LOCKER_CONTROL_ACTION
+			&& (request->action > LOCKER_ACTION_LAST
+				|| ((request->flags & LOCKER_CONTROL_FLAG_WAIT)
+					&& request->action
+					!= LOCKER_ACTION_LOCK)))
+		res = _locker_control_reply(client,
+				LOCKER_CONTROL_STATUS_INVALID, NULL, 0);
+	else if(request->command == LOCKER_CONTROL_ACTION)
+	{
+		/* reply once locked if requested, possibly right away */
+		wait = (request->flags & LOCKER_CONTROL_FLAG_WAIT)
+			? TRUE : FALSE;
+		client->wait = wait;
+		client->replied = FALSE;
+		ret = _locker_action(locker, request->action);
+		if(client->replied)
+			/* already answered while locking */
+			res = 0;
+		else if(ret == 0)
+			res = wait ? 0 : _locker_control_reply(client,
+					LOCKER_CONTROL_STATUS_OK, NULL, 0);
+		else
+		{
+			client->wait = FALSE;
+			res = _locker_control_reply(client,
+					LOCKER_CONTROL_STATUS_ERROR, NULL, 0);
+		}
+	}
+	else if(request->command == LOCKER_CONTROL_SUBSCRIBE)
+	{
+		if((res = _locker_control_reply(client,
+						LOCKER_CONTROL_STATUS_OK, NULL,
+						0)) == 0)
+			client->subscribed = TRUE;
+	}
+	else if(request->command == LOCKER_CONTROL_LATENCY)
+	{
+		if(locker->lt_stats[LLS_LOCKED].count == 0
+				|| (report = _locker_latency_report(locker))
+				== NULL)
+			res = _locker_control_reply(client,
+					LOCKER_CONTROL_STATUS_ERROR, NULL, 0);
+		else
+		{
+			res = _locker_control_reply(client,
+					LOCKER_CONTROL_STATUS_OK, report,
+					string_get_length(report));
+			string_delete(report);
+		}
+	}
+	else
+		res = _locker_control_reply(client,
+				LOCKER_CONTROL_STATUS_INVALID, NULL, 0);
+	if(res != 0)
+	{
+		client->source = 0;
+		_locker_control_close(locker, client);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+
+/* locker_on_demo_frame */
+static gboolean _locker_on_demo_frame(gint64 time, gpointer data)
+{
+	Locker * locker = data;
+	LockerDemoBuffer * buffer;
+	size_t i;
+	size_t j;
+	size_t cnt = 0;
+	(void) time;
+
+	if(locker->dm_jobs > 0)
+		/* the previous frame is still being rendered */
+		return TRUE;
+	locker->dm_elapsed = _locker_frame_elapsed(locker);
+	for(i = 0; i < locker->windows_cnt; i++)
+		if((buffer = _locker_demo_prepare(locker, i)) != NULL)
+		{
+			buffer->pending = TRUE;
+			cnt += buffer->tiles_cnt;
+		}
+	if(cnt == 0)
+		return TRUE;
+	if(locker->dm_pool == NULL || cnt == 1)
+	{
+		/* render on this thread instead, tile by tile */
+		for(i = 0; i < locker->dm_buffers_cnt; i++)
+		{
+			buffer = &locker->dm_buffers[i];
+			for(j = 0; buffer->pending && j < buffer->tiles_cnt;
+					j++)
+				_locker_demo_render(locker, &buffer->tiles[j]);
+		}
+		_locker_demo_flip(locker);
+		return TRUE;
+	}
+	/* render every tile of every monitor in parallel */
+	g_atomic_int_set(&locker->dm_pending, cnt);
+	locker->dm_jobs = cnt;
+	for(i = 0; i < locker->dm_buffers_cnt; i++)
+		if(locker->dm_buffers[i].pending)
+			for(j = 0; j < locker->dm_buffers[i].tiles_cnt; j++)
+				g_thread_pool_push(locker->dm_pool,
+						&locker->dm_buffers[i].tiles[j],
+						NULL);
+	return TRUE;
+}
+
+
+/* locker_on_demo_present */
+static gboolean _locker_on_demo_present(gpointer data)
+{
+	Locker * locker = data;
+
+	/* every frame was rendered */
+	for(; locker->dm_jobs > 0; locker->dm_jobs--)
+		g_async_queue_pop(locker->dm_done);
+	g_atomic_int_set(&locker->dm_present, 0);
+	_locker_demo_flip(locker);
+	return FALSE;
+}
+
+
+/* locker_on_demo_render */
+static void _locker_on_demo_render(gpointer data, gpointer user_data)
+{
+	LockerDemoTile * tile = data;
+	Locker * locker = user_data;
+
+	_locker_demo_render(locker, tile);
+	/* the last tile rendered presents every frame on the main thread */
+	if(g_atomic_int_dec_and_test(&locker->dm_pending))
+		g_atomic_int_set(&locker->dm_present, g_idle_add(
+					_locker_on_demo_present, locker));
+	g_async_queue_push(locker->dm_done, tile);
+}
+
+
+/* locker_on_demo_timeout */
+static gboolean _locker_on_demo_timeout(gpointer data)
+{
+	Locker * locker = data;
+
+	locker->dm_source = 0;
+	locker->dm_frame = _locker_frame_add(locker, LOCKER_DEMO_RATE,
+			_locker_on_demo_frame, locker);
+	return FALSE;
+}
+
+
+/* locker_on_demo_trim */
+static gboolean _locker_on_demo_trim(gpointer data)
+{
+	Locker * locker = data;
+	guint source = locker->dm_trim;
+
+	locker->dm_trim = 0;
+	_locker_demo_trim(locker, FALSE);
+	if(locker->dm_memory_cnt == 0)
+		return FALSE;
+	/* check again later */
+	locker->dm_trim = source;
+	return TRUE;
+}
+
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+/* locker_on_draw */
+static gboolean _locker_on_draw(GtkWidget * widget, cairo_t * cairo,
+		gpointer data)
+{
+	Locker * locker = data;
+	(void) cairo;
+
+	_locker_latency_window(locker, widget, LLS_PAINTED);
+	_locker_demo_expose(locker, widget);
+	return FALSE;
+}
+#else
+/* locker_on_expose_event */
+static gboolean _locker_on_expose_event(GtkWidget * widget, GdkEvent * event,
+		gpointer data)
+{
+	Locker * locker = data;
+	(void) event;
+
+	_locker_latency_window(locker, widget, LLS_PAINTED);
+	_locker_demo_expose(locker, widget);
+	return FALSE;
+}
+#endif
+
+
 /* locker_on_filter */
 static GdkFilterReturn _filter_configure(Locker * locker);
 static GdkFilterReturn _filter_xscreensaver_notify(Locker * locker,
@@ -2300,6 +5196,7 @@ static void _filter_xscreensaver_notify_on(Locker * locker)
 	if(locker->locked != FALSE)
 		/* we are already locked */
 		return;
+	_locker_latency_start(locker);
 	_locker_activate(locker, 0);
 	if((p = config_get(locker->config, NULL, "lock")) == NULL)
 		/* do not lock at all */
@@ -2317,12 +5214,62 @@ static void _filter_xscreensaver_notify_on(Locker * locker)
 }
 
 
+/* locker_on_frame_timeout */
+static gboolean _locker_on_frame_timeout(gpointer data)
+{
+	Locker * locker = data;
+	gint64 period;
+	gint64 now;
+	gint64 delay;
+
+	locker->fr_source = 0;
+	period = G_USEC_PER_SEC / _locker_frame_rate(locker);
+	now = g_get_monotonic_time();
+	_locker_frame_dispatch(locker, now, now + period);
+	/* check if the frames were stopped, or restarted */
+	if(locker->fr_frames_cnt == 0 || locker->fr_source != 0)
+		return FALSE;
+	/* keep a steady pace, instead of drifting by the rendering time */
+	period = G_USEC_PER_SEC / _locker_frame_rate(locker);
+	now = g_get_monotonic_time();
+	locker->fr_time += period;
+	/* drop the frames already late */
+	if(locker->fr_time < now)
+		locker->fr_time = now;
+	delay = (locker->fr_time - now) / 1000;
+	locker->fr_source = g_timeout_add(delay, _locker_on_frame_timeout,
+			locker);
+	return FALSE;
+}
+
+
+#if GTK_CHECK_VERSION(3, 8, 0)
+/* locker_on_frame_update */
+static void _locker_on_frame_update(GdkFrameClock * clock, gpointer data)
+{
+	Locker * locker = data;
+	gint64 time;
+	gint64 interval;
+	gint64 presentation;
+
+	time = gdk_frame_clock_get_frame_time(clock);
+	gdk_frame_clock_get_refresh_info(clock, time, &interval, &presentation);
+	if(presentation == 0)
+		presentation = time + ((interval != 0) ? interval
+				: G_USEC_PER_SEC / LOCKER_FRAME_RATE);
+	_locker_frame_dispatch(locker, time, presentation);
+}
+#endif
+
+
 /* locker_on_lock */
 static gboolean _locker_on_lock(gpointer data)
 {
 	Locker * locker = data;
 
 	locker->source = 0;
+	/* measure from the end of the delay configured */
+	_locker_latency_start(locker);
 	_locker_lock(locker, 0);
 	return FALSE;
 }
@@ -2333,9 +5280,11 @@ static gboolean _locker_on_map_event(GtkWidget * widget, GdkEvent * event,
 		gpointer data)
 {
 	Locker * locker = data;
+	size_t i;
 	size_t primary;
 	GdkWindow * window;
 	GdkGrabStatus status;
+	gboolean grabbed = TRUE;
 #if GTK_CHECK_VERSION(3, 0, 0)
 	GdkDisplay * display;
 	GdkDeviceManager * manager;
@@ -2344,6 +5293,10 @@ static gboolean _locker_on_map_event(GtkWidget * widget, GdkEvent * event,
 #endif
 	(void) event;
 
+	_locker_latency_window(locker, widget, LLS_MAPPED);
+	for(i = 0; i < locker->windows_cnt; i++)
+		if(locker->windows[i] == widget)
+			_locker_control_event(locker, "mapped", i, NULL);
 	/* detect if this is the primary window */
 	primary = _locker_get_primary_monitor(locker);
 	if(locker->windows[primary] != widget)
@@ -2356,7 +5309,10 @@ static gboolean _locker_on_map_event(GtkWidget * widget, GdkEvent * event,
 	window = locker->windows[primary]->window;
 #endif
 	if(window == NULL)
+	{
 		_locker_error(NULL, "Failed to grab input", 1);
+		grabbed = FALSE;
+	}
 	else
 	{
 #if GTK_CHECK_VERSION(3, 0, 0)
@@ -2369,7 +5325,10 @@ static gboolean _locker_on_map_event(GtkWidget * widget, GdkEvent * event,
 						GDK_OWNERSHIP_WINDOW, FALSE, 0,
 						NULL, GDK_CURRENT_TIME))
 				!= GDK_GRAB_SUCCESS)
+		{
 			_locker_error(NULL, "Failed to grab keyboard", 1);
+			grabbed = FALSE;
+		}
 # ifdef DEBUG
 		fprintf(stderr, "DEBUG: keyboard grab status=%u\n", status);
 # endif
@@ -2377,23 +5336,43 @@ static gboolean _locker_on_map_event(GtkWidget * widget, GdkEvent * event,
 						GDK_OWNERSHIP_WINDOW, FALSE, 0,
 						NULL, GDK_CURRENT_TIME))
 				!= GDK_GRAB_SUCCESS)
+		{
 			_locker_error(NULL, "Failed to grab mouse", 1);
+			grabbed = FALSE;
+		}
 #else
 		if((status = gdk_keyboard_grab(window, TRUE, GDK_CURRENT_TIME))
 				!= GDK_GRAB_SUCCESS)
+		{
 			_locker_error(NULL, "Failed to grab keyboard", 1);
+			grabbed = FALSE;
+		}
 # ifdef DEBUG
 		fprintf(stderr, "DEBUG: keyboard grab status=%u\n", status);
 # endif
 		if((status = gdk_pointer_grab(window, TRUE, 0, window, NULL,
 						GDK_CURRENT_TIME))
 				!= GDK_GRAB_SUCCESS)
+		{
 			_locker_error(NULL, "Failed to grab mouse", 1);
+			grabbed = FALSE;
+		}
 #endif
 #ifdef DEBUG
 		fprintf(stderr, "DEBUG: mouse grab status=%u\n", status);
 #endif
 	}
+	if((locker->grabbed = grabbed) == TRUE)
+	{
+		_locker_control_event(locker, "grabbed", primary, NULL);
+		_locker_latency_stage(locker, LLS_GRABBED);
+	}
+	else
+	{
+		/* the screen is not locked: do not let the clients wait */
+		_locker_control_locked(locker, LOCKER_CONTROL_STATUS_ERROR);
+		_locker_latency_cancel(locker);
+	}
 	return FALSE;
 }
 
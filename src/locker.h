@@ -37,6 +37,7 @@
 /* constants */
 # define LOCKER_CONFIG_VENDOR	"DeforaOS/" VENDOR
 # define LOCKER_CONFIG_FILE	"Locker.conf"
+# define LOCKER_MANIFEST_FILE	"plugins.cache"
 
 
 /* functions */
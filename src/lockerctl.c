@@ -25,14 +25,19 @@
 
 
 
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <locale.h>
 #include <libintl.h>
-#include <gtk/gtk.h>
-#include <Desktop.h>
-#include "../include/Locker.h"
+#include <X11/Xlib.h>
+#include "../include/Locker/locker.h"
+#include "control.h"
 #include "../config.h"
 #define _(string) gettext(string)
 
@@ -50,41 +55,260 @@
 # define PROGNAME	"lockerctl"
 #endif
 
+/* time to wait for the screen to be locked (in seconds) */
+#define LOCKERCTL_TIMEOUT	10
+
 
 /* lockerctl */
 /* private */
+/* prototypes */
+static int _lockerctl_connect(void);
+static int _lockerctl_error(char const * message, int ret);
+static int _lockerctl_message(int action);
+static int _lockerctl_request(LockerControlCommand command, int action,
+		unsigned int flags);
+
+
 /* functions */
 /* lockerctl */
-static int _lockerctl(int action)
+static int _lockerctl(int action, int wait)
+{
+	return _lockerctl_request(LOCKER_CONTROL_ACTION, action,
+			wait ? LOCKER_CONTROL_FLAG_WAIT : 0);
+}
+
+
+/* lockerctl_connect */
+static int _lockerctl_connect(void)
 {
-	desktop_message_send(LOCKER_CLIENT_MESSAGE, LOCKER_MESSAGE_ACTION,
-			action, TRUE);
+	int fd;
+	char * path;
+	struct sockaddr_un sa;
+
+	int e;
+
+	if((path = locker_control_path(NULL)) == NULL)
+		return -1;
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", path);
+	free(path);
+	if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return -1;
+	if(connect(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0)
+	{
+		e = errno;
+		close(fd);
+		errno = e;
+		return -1;
+	}
+	return fd;
+}
+
+
+/* lockerctl_error */
+static int _lockerctl_error(char const * message, int ret)
+{
+	fprintf(stderr, "%s: %s%s%s\n", PROGNAME, (message != NULL)
+			? message : "", (message != NULL && errno != 0)
+			? ": " : "", (errno != 0) ? strerror(errno) : "");
+	return ret;
+}
+
+
+/* lockerctl_follow */
+static int _lockerctl_follow(void)
+{
+	return _lockerctl_request(LOCKER_CONTROL_SUBSCRIBE, 0, 0);
+}
+
+
+/* lockerctl_latency */
+static int _lockerctl_latency(void)
+{
+	return _lockerctl_request(LOCKER_CONTROL_LATENCY, 0, 0);
+}
+
+
+/* lockerctl_message */
+static int _lockerctl_message(int action)
+{
+	Display * display;
+	XEvent xev;
+	Window root;
+	Window parent;
+	Window * children;
+	unsigned int cnt;
+	unsigned int i;
+
+	/* as desktop_message_send(), to every top-level window */
+	if((display = XOpenDisplay(NULL)) == NULL)
+		return -1;
+	memset(&xev, 0, sizeof(xev));
+	xev.xclient.type = ClientMessage;
+	xev.xclient.display = display;
+	xev.xclient.message_type = XInternAtom(display, LOCKER_CLIENT_MESSAGE,
+			False);
+	xev.xclient.format = 32;
+	xev.xclient.data.l[0] = LOCKER_MESSAGE_ACTION;
+	xev.xclient.data.l[1] = action;
+	xev.xclient.data.l[2] = True;
+	if(XQueryTree(display, DefaultRootWindow(display), &root, &parent,
+				&children, &cnt) == 0)
+	{
+		XCloseDisplay(display);
+		return -1;
+	}
+	for(i = 0; i < cnt; i++)
+	{
+		xev.xclient.window = children[i];
+		XSendEvent(display, children[i], False, NoEventMask, &xev);
+	}
+	if(children != NULL)
+		XFree(children);
+	XCloseDisplay(display);
 	return 0;
 }
 
 
+/* lockerctl_request */
+static int _lockerctl_request(LockerControlCommand command, int action,
+		unsigned int flags)
+{
+	int ret = 0;
+	int fd;
+	LockerControlMessage message;
+	struct timeval tv;
+	char buf[BUFSIZ];
+	size_t size;
+	ssize_t s;
+	int e;
+
+	if((fd = _lockerctl_connect()) < 0)
+	{
+		e = errno;
+		/* reach lockers without the control socket as well */
+		if(command == LOCKER_CONTROL_ACTION
+				&& (flags & LOCKER_CONTROL_FLAG_WAIT) == 0
+				&& _lockerctl_message(action) == 0)
+			return 0;
+		errno = e;
+		return -_lockerctl_error(_("Could not reach the screensaver"),
+				1);
+	}
+	if(flags & LOCKER_CONTROL_FLAG_WAIT)
+	{
+		tv.tv_sec = LOCKERCTL_TIMEOUT;
+		tv.tv_usec = 0;
+		if(setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv))
+				!= 0)
+		{
+			close(fd);
+			return -_lockerctl_error(NULL, 1);
+		}
+	}
+	memset(&message, 0, sizeof(message));
+	message.id = getpid();
+	message.command = command;
+	message.action = action;
+	message.flags = flags;
+	if(locker_control_write(fd, &message, sizeof(message)) != 0
+			|| locker_control_read(fd, &message, sizeof(message))
+			!= 0)
+	{
+		close(fd);
+		if(errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			errno = 0;
+			return -_lockerctl_error(
+					_("Timeout while locking the screen"),
+					1);
+		}
+		return -_lockerctl_error(_("Communication error"), 1);
+	}
+	if(message.id != (uint32_t)getpid())
+	{
+		errno = EPROTO;
+		ret = -1;
+	}
+	/* output the data returned */
+	for(; ret == 0 && message.length > 0; message.length -= size)
+	{
+		size = (message.length < sizeof(buf)) ? message.length
+			: sizeof(buf);
+		if(locker_control_read(fd, buf, size) != 0)
+			ret = -1;
+		else
+			fwrite(buf, sizeof(*buf), size, stdout);
+	}
+	/* output the events as they come */
+	if(ret == 0 && command == LOCKER_CONTROL_SUBSCRIBE
+			&& message.status == LOCKER_CONTROL_STATUS_OK)
+		while((s = read(fd, buf, sizeof(buf))) != 0)
+		{
+			if(s > 0)
+			{
+				fwrite(buf, sizeof(*buf), s, stdout);
+				fflush(stdout);
+			}
+			else if(errno != EINTR)
+			{
+				ret = -1;
+				break;
+			}
+		}
+	close(fd);
+	if(ret != 0)
+		return -_lockerctl_error(_("Communication error"), 1);
+	errno = 0;
+	switch(message.status)
+	{
+		case LOCKER_CONTROL_STATUS_OK:
+			return 0;
+		case LOCKER_CONTROL_STATUS_INVALID:
+			return -_lockerctl_error(_("Invalid request"), 1);
+		default:
+			if(command == LOCKER_CONTROL_LATENCY)
+				return -_lockerctl_error(
+						_("No lock latency recorded"),
+						1);
+			if(flags & LOCKER_CONTROL_FLAG_WAIT)
+				return -_lockerctl_error(
+						_("Could not lock the screen"),
+						1);
+			return -_lockerctl_error(_("Request failed"), 1);
+	}
+}
+
+
 /* usage */
 static int _usage(void)
 {
 #ifdef EMBEDDED
-	fprintf(stderr, _("Usage: %s [-D|-E|-S|-c|-l|-s|-u|-z]\n"
+	fprintf(stderr, _("Usage: %s [-D|-E|-F|-L|-S|-c|-l|-s|-u|-w|-z]\n"
 "  -D	Temporarily disable the screensaver\n"
 "  -E	Enable the screensaver again\n"
+"  -F	Follow the events of the screensaver\n"
+"  -L	Display lock latency statistics\n"
 "  -S	Display or change settings\n"
 "  -c	Cycle the screen saver\n"
 "  -l	Lock the screen\n"
 "  -s	Activate the screen saver\n"
 "  -u	Unlock the screen\n"
+"  -w	Lock the screen and wait until it is locked\n"
 "  -z	Suspend the device\n"), PROGNAME);
 #else
-	fprintf(stderr, _("Usage: %s [-D|-E|-S|-c|-l|-s|-u|-z]\n"
+	fprintf(stderr, _("Usage: %s [-D|-E|-F|-L|-S|-c|-l|-s|-u|-w|-z]\n"
 "  -D	Temporarily disable the screensaver\n"
 "  -E	Enable the screensaver again\n"
+"  -F	Follow the events of the screensaver\n"
+"  -L	Display lock latency statistics\n"
 "  -S	Display or change settings\n"
 "  -c	Cycle the screen saver\n"
 "  -l	Lock the screen\n"
 "  -s	Activate the screen saver\n"
 "  -u	Unlock the screen\n"
+"  -w	Lock the screen and wait until it is locked\n"
 "  -z	Suspend the computer\n"), PROGNAME);
 #endif
 	return 1;
@@ -98,12 +322,14 @@ int main(int argc, char * argv[])
 {
 	int o;
 	int action = -1;
+	int follow = 0;
+	int latency = 0;
+	int wait = 0;
 
 	setlocale(LC_ALL, "");
 	bindtextdomain(PACKAGE, LOCALEDIR);
 	textdomain(PACKAGE);
-	gtk_init(&argc, &argv);
-	while((o = getopt(argc, argv, "DESclsuz")) != -1)
+	while((o = getopt(argc, argv, "DEFLSclsuwz")) != -1)
 		switch(o)
 		{
 			case 'D':
@@ -116,6 +342,12 @@ int main(int argc, char * argv[])
 					return _usage();
 				action = LOCKER_ACTION_ENABLE;
 				break;
+			case 'F':
+				follow = 1;
+				break;
+			case 'L':
+				latency = 1;
+				break;
 			case 'S':
 				if(action != -1)
 					return _usage();
@@ -141,6 +373,9 @@ int main(int argc, char * argv[])
 					return _usage();
 				action = LOCKER_ACTION_UNLOCK;
 				break;
+			case 'w':
+				wait = 1;
+				break;
 			case 'z':
 				if(action != -1)
 					return _usage();
@@ -149,7 +384,22 @@ int main(int argc, char * argv[])
 			default:
 				return _usage();
 		}
-	if(action == -1 || optind != argc)
+	if(optind != argc)
+		return _usage();
+	if((follow || latency) && (action != -1 || wait))
+		return _usage();
+	if(follow && latency)
+		return _usage();
+	if(follow)
+		return (_lockerctl_follow() == 0) ? 0 : 2;
+	/* waiting only applies to locking */
+	if(wait && action == -1)
+		action = LOCKER_ACTION_LOCK;
+	else if(wait && action != LOCKER_ACTION_LOCK)
+		return _usage();
+	if(latency)
+		return (_lockerctl_latency() == 0) ? 0 : 2;
+	if(action == -1)
 		return _usage();
-	return (_lockerctl(action) == 0) ? 0 : 2;
+	return (_lockerctl(action, wait) == 0) ? 0 : 2;
 }
@@ -56,7 +56,9 @@ LockerPluginDefinition plugin =
 	NULL,
 	_debug_init,
 	_debug_destroy,
-	_debug_event
+	_debug_event,
+	LOCKER_EVENT_MASK_ALL,
+	0
 };
 
 
@@ -96,6 +98,15 @@ static int _debug_event(Debug * debug, LockerEvent event)
 		case LOCKER_EVENT_ACTIVATING:
 			fprintf(stderr, "DEBUG: %s() ACTIVATING\n", __func__);
 			break;
+		case LOCKER_EVENT_AUTH_FAILED:
+			fprintf(stderr, "DEBUG: %s() AUTH_FAILED\n", __func__);
+			break;
+		case LOCKER_EVENT_CYCLED:
+			fprintf(stderr, "DEBUG: %s() CYCLED\n", __func__);
+			break;
+		case LOCKER_EVENT_CYCLING:
+			fprintf(stderr, "DEBUG: %s() CYCLING\n", __func__);
+			break;
 		case LOCKER_EVENT_DEACTIVATED:
 			fprintf(stderr, "DEBUG: %s() DEACTIVATED\n", __func__);
 			break;
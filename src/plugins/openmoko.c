@@ -83,7 +83,9 @@ LockerPluginDefinition plugin =
 	NULL,
 	_openmoko_init,
 	_openmoko_destroy,
-	_openmoko_event
+	_openmoko_event,
+	LOCKER_EVENT_MASK(LOCKER_EVENT_SUSPENDING),
+	0
 };
 
 
@@ -60,7 +60,12 @@ LockerPluginDefinition plugin =
 	NULL,
 	_suspend_init,
 	_suspend_destroy,
-	_suspend_event
+	_suspend_event,
+	LOCKER_EVENT_MASK(LOCKER_EVENT_ACTIVATED)
+		| LOCKER_EVENT_MASK(LOCKER_EVENT_DEACTIVATED)
+		| LOCKER_EVENT_MASK(LOCKER_EVENT_LOCKED)
+		| LOCKER_EVENT_MASK(LOCKER_EVENT_UNLOCKED),
+	LOCKER_PLUGIN_FLAG_ON_DEMAND
 };
 
 
@@ -70,7 +70,9 @@ LockerPluginDefinition plugin =
 	NULL,
 	_systray_init,
 	_systray_destroy,
-	NULL
+	NULL,
+	0,
+	0
 };
 
 
@@ -56,7 +56,9 @@ LockerPluginDefinition plugin =
 	NULL,
 	_template_init,
 	_template_destroy,
-	_template_event
+	_template_event,
+	LOCKER_EVENT_MASK_ALL,
+	0
 };
 
 
@@ -100,6 +102,21 @@ static int _template_event(Template * template, LockerEvent event)
 		case LOCKER_EVENT_ACTIVATING:
 #ifdef DEBUG
 			fprintf(stderr, "DEBUG: %s() ACTIVATING\n", __func__);
+#endif
+			break;
+		case LOCKER_EVENT_AUTH_FAILED:
+#ifdef DEBUG
+			fprintf(stderr, "DEBUG: %s() AUTH_FAILED\n", __func__);
+#endif
+			break;
+		case LOCKER_EVENT_CYCLED:
+#ifdef DEBUG
+			fprintf(stderr, "DEBUG: %s() CYCLED\n", __func__);
+#endif
+			break;
+		case LOCKER_EVENT_CYCLING:
+#ifdef DEBUG
+			fprintf(stderr, "DEBUG: %s() CYCLING\n", __func__);
 #endif
 			break;
 		case LOCKER_EVENT_DEACTIVATED:
@@ -0,0 +1,510 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+/* the kernels are private */
+#include "../src/demos/blit.c"
+
+/* constants */
+#define PROGNAME_BLIT	"blit"
+
+/* largest row tested (plus one pixel to misalign the rows) */
+#define BLIT_WIDTH_MAX	1024
+
+
+/* private */
+/* types */
+typedef struct _BlitKernel
+{
+	char const * name;
+	BlitOverFunc over;
+	BlitNearestFunc nearest;
+	BlitBilinearFunc bilinear;
+	int (*supported)(void);
+} BlitKernel;
+
+
+/* prototypes */
+static int _blit(void);
+static int _blit_clip(void);
+static int _blit_kernels(void);
+static int _blit_samplers(void);
+static int _blit_scale(void);
+
+#ifdef BLIT_X86
+static int _supported_avx2(void);
+static int _supported_sse2(void);
+#endif
+
+static uint32_t _pixel(void);
+
+static int _error(char const * message, char const * error, int ret);
+
+
+/* variables */
+static const BlitKernel _kernels[] =
+{
+#if defined(BLIT_X86)
+	{ "avx2", _blit_over_avx2, _blit_nearest_avx2, _blit_bilinear_avx2,
+		_supported_avx2 },
+	{ "sse2", _blit_over_sse2, NULL, _blit_bilinear_sse2,
+		_supported_sse2 },
+#elif defined(BLIT_NEON)
+	{ "neon", _blit_over_neon, NULL, _blit_bilinear_neon, NULL },
+#endif
+	{ NULL, NULL, NULL, NULL, NULL }
+};
+
+
+/* functions */
+/* blit */
+static int _blit(void)
+{
+	int ret = 0;
+
+	printf("%s: %s\n", PROGNAME_BLIT, blit_get_name());
+	ret += _blit_kernels();
+	ret += _blit_samplers();
+	ret += _blit_clip();
+	ret += _blit_scale();
+	return ret;
+}
+
+
+/* blit_clip */
+static int _blit_clip_test(int x, int y, double scale, BlitFilter filter);
+
+static int _blit_clip(void)
+{
+	int ret = 0;
+	const int positions[][2] =
+	{
+		{ 0, 0 }, { -3, -2 }, { 13, 11 }, { -3, 11 }, { 13, -2 },
+		{ -100, 0 }, { 0, -100 }, { 100, 0 }, { 0, 100 },
+		{ -9, -9 }, { 16, 16 }, { 15, 15 }, { -5, 4 }
+	};
+	const double scales[] = { 1.0, 2.0, 0.5, 1.5 };
+	size_t i;
+	size_t j;
+	BlitFilter f;
+
+	for(i = 0; i < sizeof(positions) / sizeof(*positions); i++)
+		for(j = 0; j < sizeof(scales) / sizeof(*scales); j++)
+			for(f = 0; f < BLIT_FILTER_COUNT; f++)
+				ret += _blit_clip_test(positions[i][0],
+						positions[i][1], scales[j], f);
+	return ret;
+}
+
+static int _blit_clip_test(int x, int y, double scale, BlitFilter filter)
+{
+	/* the destination has a guard band on every side */
+	const int guard = 4;
+	const int width = 16;
+	const int height = 16;
+	const int stride = width + guard * 2;
+	const uint32_t background = 0x80402010;
+	const uint32_t foreground = 0xff00ff00;
+	const int src_width = 7;
+	const int src_height = 5;
+	uint32_t dst[(16 + 4 * 2) * (16 + 4 * 2)];
+	uint32_t src[7 * 5];
+	int w;
+	int h;
+	int i;
+	int j;
+	int inside;
+	uint32_t expected;
+	char buf[80];
+
+	for(i = 0; i < stride * (height + guard * 2); i++)
+		dst[i] = background;
+	for(i = 0; i < src_width * src_height; i++)
+		src[i] = foreground;
+	blit_composite((unsigned char *)&dst[stride * guard + guard],
+			stride * sizeof(*dst), width, height,
+			(unsigned char const *)src, src_width * sizeof(*src),
+			src_width, src_height, x, y, scale, 255, filter);
+	w = ceil(src_width * scale);
+	h = ceil(src_height * scale);
+	for(j = -guard; j < height + guard; j++)
+		for(i = -guard; i < width + guard; i++)
+		{
+			inside = (i >= 0 && i < width && j >= 0 && j < height
+					&& i >= x && i < x + w
+					&& j >= y && j < y + h);
+			expected = inside ? foreground : background;
+			if(dst[(j + guard) * stride + i + guard] == expected)
+				continue;
+			snprintf(buf, sizeof(buf), "%d,%d (scale %.1f, filter"
+					" %u): pixel %d,%d is %08x instead of"
+					" %08x", x, y, scale, filter, i, j,
+					dst[(j + guard) * stride + i + guard],
+					expected);
+			return _error("blit_composite", buf, 1);
+		}
+	return 0;
+}
+
+
+/* blit_kernels */
+static int _blit_kernels_test(BlitKernel const * kernel, size_t width,
+		unsigned int alpha, size_t offset);
+
+static int _blit_kernels(void)
+{
+	int ret = 0;
+	const size_t widths[] = { 1, 3, 5, 7, 9, 15, 17, 31, 33, 63, 65, 255,
+		257, 1023 };
+	const unsigned int alphas[] = { 1, 127, 128, 254, 255 };
+	size_t i;
+	size_t j;
+	size_t k;
+	size_t offset;
+
+	srand(0);
+	for(i = 0; _kernels[i].name != NULL; i++)
+	{
+		if(_kernels[i].supported != NULL
+				&& _kernels[i].supported() == 0)
+		{
+			printf("%s: %s: not supported, skipping\n",
+					PROGNAME_BLIT, _kernels[i].name);
+			continue;
+		}
+		printf("%s: %s: testing\n", PROGNAME_BLIT, _kernels[i].name);
+		for(j = 0; j < sizeof(widths) / sizeof(*widths); j++)
+			for(k = 0; k < sizeof(alphas) / sizeof(*alphas); k++)
+				for(offset = 0; offset < 2; offset++)
+					ret += _blit_kernels_test(&_kernels[i],
+							widths[j], alphas[k],
+							offset);
+	}
+	return ret;
+}
+
+static int _blit_kernels_test(BlitKernel const * kernel, size_t width,
+		unsigned int alpha, size_t offset)
+{
+	uint32_t src[BLIT_WIDTH_MAX + 1];
+	uint32_t dst[BLIT_WIDTH_MAX + 1];
+	uint32_t expected[BLIT_WIDTH_MAX + 1];
+	size_t i;
+	char buf[80];
+
+	for(i = 0; i < BLIT_WIDTH_MAX + 1; i++)
+	{
+		src[i] = _pixel();
+		dst[i] = _pixel();
+	}
+	memcpy(expected, dst, sizeof(expected));
+	_blit_over_scalar(&expected[offset], &src[offset], width, alpha);
+	kernel->over(&dst[offset], &src[offset], width, alpha);
+	for(i = 0; i < BLIT_WIDTH_MAX + 1; i++)
+	{
+		if(dst[i] == expected[i])
+			continue;
+		snprintf(buf, sizeof(buf), "width %zu, alpha %u, offset %zu:"
+				" pixel %zu is %08x instead of %08x",
+				width, alpha, offset, i, dst[i], expected[i]);
+		return _error(kernel->name, buf, 1);
+	}
+	return 0;
+}
+
+
+/* blit_samplers */
+static int _blit_samplers_test(BlitKernel const * kernel, BlitFilter filter,
+		int src_width, int32_t fx, int32_t dx, size_t width);
+
+static int _blit_samplers(void)
+{
+	int ret = 0;
+	const int src_widths[] = { 1, 2, 7, 33, 1023 };
+	/* steps for the scales 2, 1.5, 0.5 and 0.3 (in 16.16 fixed point) */
+	const int32_t steps[] = { 32768, 43690, 131072, 218453 };
+	const size_t widths[] = { 1, 3, 7, 8, 9, 17, 31, 255, 1023 };
+	size_t i;
+	size_t j;
+	size_t k;
+	int32_t fx;
+
+	srand(0);
+	for(i = 0; _kernels[i].name != NULL; i++)
+	{
+		if(_kernels[i].supported != NULL
+				&& _kernels[i].supported() == 0)
+			continue;
+		for(j = 0; j < sizeof(src_widths) / sizeof(*src_widths); j++)
+			for(k = 0; k < sizeof(steps) / sizeof(*steps); k++)
+			{
+				fx = steps[k] / 2;
+				ret += _blit_samplers_test(&_kernels[i],
+						BLIT_FILTER_NEAREST,
+						src_widths[j], fx, steps[k],
+						widths[(j + k)
+						% (sizeof(widths)
+							/ sizeof(*widths))]);
+				/* starts before the first pixel */
+				ret += _blit_samplers_test(&_kernels[i],
+						BLIT_FILTER_BILINEAR,
+						src_widths[j], fx - 32768,
+						steps[k], widths[(j + k + 3)
+						% (sizeof(widths)
+							/ sizeof(*widths))]);
+			}
+	}
+	return ret;
+}
+
+static int _blit_samplers_test(BlitKernel const * kernel, BlitFilter filter,
+		int src_width, int32_t fx, int32_t dx, size_t width)
+{
+	uint32_t row0[BLIT_WIDTH_MAX];
+	uint32_t row1[BLIT_WIDTH_MAX];
+	uint32_t dst[BLIT_WIDTH_MAX];
+	uint32_t expected[BLIT_WIDTH_MAX];
+	const unsigned int wy = 77;
+	size_t i;
+	char buf[80];
+
+	for(i = 0; i < BLIT_WIDTH_MAX; i++)
+	{
+		row0[i] = _pixel();
+		row1[i] = _pixel();
+	}
+	if(filter == BLIT_FILTER_BILINEAR)
+	{
+		_blit_bilinear_scalar(expected, row0, row1, wy, src_width, fx,
+				dx, width);
+		kernel->bilinear(dst, row0, row1, wy, src_width, fx, dx,
+				width);
+	}
+	else if(kernel->nearest != NULL)
+	{
+		_blit_nearest_scalar(expected, row0, src_width, fx, dx, width);
+		kernel->nearest(dst, row0, src_width, fx, dx, width);
+	}
+	else
+		return 0;
+	for(i = 0; i < width; i++)
+	{
+		if(dst[i] == expected[i])
+			continue;
+		snprintf(buf, sizeof(buf), "filter %u, source %d, step %d:"
+				" pixel %zu is %08x instead of %08x", filter,
+				src_width, dx, i, dst[i], expected[i]);
+		return _error(kernel->name, buf, 1);
+	}
+	return 0;
+}
+
+
+/* blit_scale */
+static int _blit_scale_test(int x, int y, double scale, BlitFilter filter,
+		unsigned int alpha);
+static uint32_t _blit_scale_pixel(uint32_t const * src, int src_width,
+		int src_height, int i, int j, int32_t d, BlitFilter filter);
+
+static int _blit_scale(void)
+{
+	int ret = 0;
+	const int positions[][2] = { { 0, 0 }, { -3, 2 }, { 5, -1 } };
+	const double scales[] = { 0.5, 1.5, 2.0 };
+	const unsigned int alphas[] = { 128, 255 };
+	size_t i;
+	size_t j;
+	size_t k;
+	BlitFilter f;
+
+	srand(0);
+	for(i = 0; i < sizeof(positions) / sizeof(*positions); i++)
+		for(j = 0; j < sizeof(scales) / sizeof(*scales); j++)
+			for(k = 0; k < sizeof(alphas) / sizeof(*alphas); k++)
+				for(f = 0; f < BLIT_FILTER_COUNT; f++)
+					ret += _blit_scale_test(positions[i][0],
+							positions[i][1],
+							scales[j], f,
+							alphas[k]);
+	return ret;
+}
+
+static int _blit_scale_test(int x, int y, double scale, BlitFilter filter,
+		unsigned int alpha)
+{
+	const int width = 83;
+	const int height = 13;
+	const int src_width = 37;
+	const int src_height = 7;
+	uint32_t dst[83 * 13];
+	uint32_t expected[83 * 13];
+	uint32_t src[37 * 7];
+	int32_t d;
+	int i;
+	int j;
+	uint32_t p;
+	char buf[128];
+
+	/* every source pixel differs, to tell which ones are sampled */
+	for(i = 0; i < src_width * src_height; i++)
+		src[i] = _pixel();
+	for(i = 0; i < width * height; i++)
+		dst[i] = _pixel();
+	memcpy(expected, dst, sizeof(expected));
+	blit_composite((unsigned char *)dst, width * sizeof(*dst), width,
+			height, (unsigned char const *)src,
+			src_width * sizeof(*src), src_width, src_height, x, y,
+			scale, alpha, filter);
+	/* the reference samples one pixel at a time */
+	d = 65536.0 / scale;
+	for(j = 0; j < height; j++)
+		for(i = 0; i < width; i++)
+		{
+			if(i < x || i >= x + ceil(src_width * scale)
+					|| j < y
+					|| j >= y + ceil(src_height * scale))
+				continue;
+			p = _blit_scale_pixel(src, src_width, src_height,
+					i - x, j - y, d, filter);
+			_blit_over_scalar(&expected[j * width + i], &p, 1,
+					alpha);
+		}
+	for(i = 0; i < width * height; i++)
+	{
+		if(dst[i] == expected[i])
+			continue;
+		snprintf(buf, sizeof(buf), "%d,%d (scale %.1f, filter %u,"
+				" alpha %u): pixel %d,%d is %08x instead of"
+				" %08x", x, y, scale, filter, alpha, i % width,
+				i / width, dst[i], expected[i]);
+		return _error("blit_composite", buf, 1);
+	}
+	return 0;
+}
+
+static uint32_t _blit_scale_pixel(uint32_t const * src, int src_width,
+		int src_height, int i, int j, int32_t d, BlitFilter filter)
+{
+	int32_t fx = i * d + d / 2;
+	int32_t fy = j * d + d / 2;
+	int sx0, sx1;
+	int sy0, sy1;
+	unsigned int wx = 0;
+	unsigned int wy = 0;
+
+	if(filter == BLIT_FILTER_NEAREST)
+	{
+		sx0 = fx >> 16;
+		sy0 = fy >> 16;
+		sx0 = (sx0 < src_width) ? sx0 : src_width - 1;
+		sy0 = (sy0 < src_height) ? sy0 : src_height - 1;
+		return src[sy0 * src_width + sx0];
+	}
+	/* the centers of the source pixels are at half the step */
+	fx -= 32768;
+	fy -= 32768;
+	if(fx >= 0)
+		wx = (fx >> 8) & 0xff;
+	if(fy >= 0)
+		wy = (fy >> 8) & 0xff;
+	sx0 = (fx < 0) ? 0 : fx >> 16;
+	sy0 = (fy < 0) ? 0 : fy >> 16;
+	sx0 = (sx0 < src_width) ? sx0 : src_width - 1;
+	sy0 = (sy0 < src_height) ? sy0 : src_height - 1;
+	sx1 = (sx0 + 1 < src_width) ? sx0 + 1 : sx0;
+	sy1 = (sy0 + 1 < src_height) ? sy0 + 1 : sy0;
+	return _blit_lerp(_blit_lerp(src[sy0 * src_width + sx0],
+				src[sy0 * src_width + sx1], wx),
+			_blit_lerp(src[sy1 * src_width + sx0],
+				src[sy1 * src_width + sx1], wx), wy);
+}
+
+
+#ifdef BLIT_X86
+/* supported_avx2 */
+static int _supported_avx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+
+/* supported_sse2 */
+static int _supported_sse2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+}
+#endif
+
+
+/* pixel */
+static uint32_t _pixel(void)
+{
+	unsigned int a;
+	unsigned int r;
+	unsigned int g;
+	unsigned int b;
+
+	/* premultiplied: no channel may exceed the alpha value */
+	switch(rand() % 4)
+	{
+		case 0:
+			a = 0;
+			break;
+		case 1:
+			a = 255;
+			break;
+		default:
+			a = rand() % 256;
+			break;
+	}
+	r = rand() % (a + 1);
+	g = rand() % (a + 1);
+	b = rand() % (a + 1);
+	return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+
+/* error */
+static int _error(char const * message, char const * error, int ret)
+{
+	fputs(PROGNAME_BLIT ": ", stderr);
+	fprintf(stderr, "%s: %s\n", message, error);
+	return ret;
+}
+
+
+/* public */
+/* functions */
+/* main */
+int main(void)
+{
+	return (_blit() == 0) ? 0 : 2;
+}
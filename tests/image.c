@@ -0,0 +1,353 @@
+/* $Id$ */
+/* Copyright (c) 2026 Pierre Pronchery <khorben@defora.org> */
+/* This file is part of DeforaOS Desktop Locker */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+
+#include <sys/time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+/* the cache is private */
+#include "../src/demos/image.c"
+
+/* constants */
+#define PROGNAME_IMAGE	"image"
+
+/* size of the image cached (with an odd width) */
+#define IMAGE_WIDTH	5
+#define IMAGE_HEIGHT	3
+
+
+/* private */
+/* types */
+typedef struct _ImageTest
+{
+	char const * name;
+	/* alters the image or its cache once saved */
+	int (*alter)(String const * path, char const * filename);
+	/* whether the cache is expected to be used then */
+	int valid;
+} ImageTest;
+
+
+/* prototypes */
+static int _image(void);
+static int _image_cache(String const * path, char const * filename,
+		cairo_surface_t * surface, ImageTest const * test);
+
+static int _alter_none(String const * path, char const * filename);
+static int _alter_magic(String const * path, char const * filename);
+static int _alter_mtime(String const * path, char const * filename);
+static int _alter_size(String const * path, char const * filename);
+static int _alter_truncate(String const * path, char const * filename);
+static int _alter_truncate_header(String const * path,
+		char const * filename);
+
+static int _cleanup(char const * directory, char const * filename,
+		String const * path);
+
+static int _error(char const * message, char const * error, int ret);
+static int _perror(char const * message, int ret);
+
+
+/* variables */
+static const ImageTest _tests[] =
+{
+	{ "valid", _alter_none, 1 },
+	{ "modification time", _alter_mtime, 0 },
+	{ "size", _alter_size, 0 },
+	{ "truncated", _alter_truncate, 0 },
+	{ "truncated header", _alter_truncate_header, 0 },
+	{ "magic", _alter_magic, 0 },
+	{ NULL, NULL, 0 }
+};
+
+
+/* functions */
+/* image */
+static int _image(void)
+{
+	int ret = 0;
+	char directory[] = "/tmp/" PROGNAME_IMAGE ".XXXXXX";
+	String * filename;
+	String * path = NULL;
+	FILE * fp;
+	cairo_surface_t * surface;
+	unsigned char * data;
+	int stride;
+	int i;
+
+	if(mkdtemp(directory) == NULL)
+		return _perror(directory, 1);
+	if(setenv("XDG_CACHE_HOME", directory, 1) != 0)
+		ret = _perror("XDG_CACHE_HOME", 1);
+	else if((filename = string_new_append(directory, "/image.png", NULL))
+			== NULL)
+		ret = _error(directory, error_get(NULL), 1);
+	else
+	{
+		/* the contents of the image do not matter to the cache */
+		if((fp = fopen(filename, "w")) == NULL
+				|| fputs(PROGNAME_IMAGE, fp) == EOF
+				|| fclose(fp) != 0)
+			ret = _perror(filename, 1);
+		else if((path = _image_cache_path(filename, IMAGE_MODE_COVER,
+						IMAGE_WIDTH, IMAGE_HEIGHT))
+				== NULL)
+			ret = _error(filename, error_get(NULL), 1);
+		else
+		{
+			surface = cairo_image_surface_create(
+					CAIRO_FORMAT_ARGB32, IMAGE_WIDTH,
+					IMAGE_HEIGHT);
+			cairo_surface_flush(surface);
+			data = cairo_image_surface_get_data(surface);
+			stride = cairo_image_surface_get_stride(surface);
+			for(i = 0; data != NULL && i < stride * IMAGE_HEIGHT;
+					i++)
+				data[i] = i * 7;
+			cairo_surface_mark_dirty(surface);
+			for(i = 0; _tests[i].name != NULL; i++)
+				ret += _image_cache(path, filename, surface,
+						&_tests[i]);
+			cairo_surface_destroy(surface);
+		}
+		ret += _cleanup(directory, filename, path);
+		string_delete(path);
+		string_delete(filename);
+	}
+	if(rmdir(directory) != 0)
+		ret += _perror(directory, 1);
+	return ret;
+}
+
+
+/* image_cache */
+static int _image_cache(String const * path, char const * filename,
+		cairo_surface_t * surface, ImageTest const * test)
+{
+	struct stat st;
+	cairo_surface_t * cached;
+	int i;
+	int stride;
+	unsigned char const * p;
+	unsigned char const * q;
+
+	printf("%s: %s\n", PROGNAME_IMAGE, test->name);
+	if(stat(filename, &st) != 0)
+		return _perror(filename, 1);
+	if(_image_cache_save(path, filename, &st, IMAGE_MODE_COVER,
+				IMAGE_WIDTH, IMAGE_HEIGHT, surface) != 0)
+		return _error(test->name, "Could not save the cache", 1);
+	if(test->alter(path, filename) != 0)
+		return _perror(test->name, 1);
+	if(stat(filename, &st) != 0)
+		return _perror(filename, 1);
+	cached = _image_cache_load(path, filename, &st, IMAGE_MODE_COVER,
+			IMAGE_WIDTH, IMAGE_HEIGHT);
+	if(!test->valid)
+	{
+		if(cached == NULL)
+			return 0;
+		cairo_surface_destroy(cached);
+		return _error(test->name, "Outdated cache used", 1);
+	}
+	if(cached == NULL)
+		return _error(test->name, "Could not load the cache", 1);
+	if(cairo_image_surface_get_width(cached) != IMAGE_WIDTH
+			|| cairo_image_surface_get_height(cached)
+			!= IMAGE_HEIGHT)
+	{
+		cairo_surface_destroy(cached);
+		return _error(test->name, "Invalid size", 1);
+	}
+	stride = cairo_image_surface_get_stride(surface);
+	p = cairo_image_surface_get_data(surface);
+	q = cairo_image_surface_get_data(cached);
+	for(i = 0; i < IMAGE_HEIGHT; i++)
+		if(memcmp(&p[stride * i], &q[cairo_image_surface_get_stride(
+							cached) * i],
+					IMAGE_WIDTH * 4) != 0)
+		{
+			cairo_surface_destroy(cached);
+			return _error(test->name, "Invalid pixels", 1);
+		}
+	cairo_surface_destroy(cached);
+	return 0;
+}
+
+
+/* alterations */
+/* alter_none */
+static int _alter_none(String const * path, char const * filename)
+{
+	(void) path;
+	(void) filename;
+
+	return 0;
+}
+
+
+/* alter_magic */
+static int _alter_magic(String const * path, char const * filename)
+{
+	int ret = 0;
+	int fd;
+
+	(void) filename;
+	if((fd = open(path, O_WRONLY)) < 0)
+		return -1;
+	if(write(fd, "X", 1) != 1)
+		ret = -1;
+	if(close(fd) != 0)
+		ret = -1;
+	return ret;
+}
+
+
+/* alter_mtime */
+static int _alter_mtime(String const * path, char const * filename)
+{
+	struct stat st;
+	struct timeval tv[2];
+
+	(void) path;
+	if(stat(filename, &st) != 0)
+		return -1;
+	tv[0].tv_sec = st.st_atime;
+	tv[0].tv_usec = 0;
+	tv[1].tv_sec = st.st_mtime - 60;
+	tv[1].tv_usec = 0;
+	return utimes(filename, tv);
+}
+
+
+/* alter_size */
+static int _alter_size(String const * path, char const * filename)
+{
+	struct stat st;
+	struct timeval tv[2];
+	FILE * fp;
+
+	(void) path;
+	/* keep the modification time */
+	if(stat(filename, &st) != 0)
+		return -1;
+	if((fp = fopen(filename, "a")) == NULL)
+		return -1;
+	if(fputs(PROGNAME_IMAGE, fp) == EOF)
+	{
+		fclose(fp);
+		return -1;
+	}
+	if(fclose(fp) != 0)
+		return -1;
+	tv[0].tv_sec = st.st_atime;
+	tv[0].tv_usec = 0;
+	tv[1].tv_sec = st.st_mtime;
+	tv[1].tv_usec = 0;
+	return utimes(filename, tv);
+}
+
+
+/* alter_truncate */
+static int _alter_truncate(String const * path, char const * filename)
+{
+	struct stat st;
+
+	(void) filename;
+	if(stat(path, &st) != 0)
+		return -1;
+	return truncate(path, st.st_size - 1);
+}
+
+
+/* alter_truncate_header */
+static int _alter_truncate_header(String const * path,
+		char const * filename)
+{
+	(void) filename;
+	return truncate(path, sizeof(ImageHeader) / 2);
+}
+
+
+/* cleanup */
+static int _cleanup(char const * directory, char const * filename,
+		String const * path)
+{
+	int ret = 0;
+	String * p;
+	char * q;
+
+	if(unlink(filename) != 0 && errno != ENOENT)
+		ret += _perror(filename, 1);
+	if(path == NULL)
+		return ret;
+	if(unlink(path) != 0 && errno != ENOENT)
+		ret += _perror(path, 1);
+	/* remove the directories of the cache, up to the one for the test */
+	if((p = string_new(path)) == NULL)
+		return ret + _error(path, error_get(NULL), 1);
+	while((q = strrchr(p, '/')) != NULL && q > p)
+	{
+		*q = '\0';
+		if(strcmp(p, directory) == 0)
+			break;
+		if(rmdir(p) != 0)
+		{
+			ret += _perror(p, 1);
+			break;
+		}
+	}
+	string_delete(p);
+	return ret;
+}
+
+
+/* error */
+static int _error(char const * message, char const * error, int ret)
+{
+	fputs(PROGNAME_IMAGE ": ", stderr);
+	fprintf(stderr, "%s: %s\n", message, error);
+	return ret;
+}
+
+
+/* perror */
+static int _perror(char const * message, int ret)
+{
+	fputs(PROGNAME_IMAGE ": ", stderr);
+	perror(message);
+	return ret;
+}
+
+
+/* public */
+/* functions */
+/* main */
+int main(void)
+{
+	return (_image() == 0) ? 0 : 2;
+}
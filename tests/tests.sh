@@ -114,6 +114,8 @@ target="$1"
 $DATE > "$target"
 FAILED=
 echo "Performing tests:" 1>&2
+_test "blit"
+_test "image"
 echo "Expected failures:" 1>&2
 _fail "auth"
 if [ -n "$FAILED" ]; then
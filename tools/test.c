@@ -45,18 +45,38 @@
 #ifndef LIBDIR
 # define LIBDIR			PREFIX "/lib"
 #endif
+#define TEST_FRAME_RATE		60
 
 
 /* private */
 /* types */
+struct _LockerConfigSection
+{
+	String * name;
+	LockerConfigSection * next;
+};
+
+typedef struct _TestFrame
+{
+	LockerDemoFrameFunc func;
+	gpointer data;
+} TestFrame;
+
 struct _Locker
 {
 	char * name;
 	Config * config;
+	LockerConfigSection * sections;
 
 	/* demo */
 	LockerDemoDefinition * dplugin;
 	LockerDemo * demo;
+	gint64 start;
+	GdkWindow * wwindow;
+	cairo_surface_t * surface;
+	/* frames since the surface was rendered into (0 if undefined) */
+	int age;
+	guint render;
 
 	/* auth */
 	LockerAuthDefinition * aplugin;
@@ -80,16 +100,35 @@ static char const * _test_helper_config_get_auth(Locker * locker,
 		char const * section, char const * variable);
 static char const * _test_helper_config_get_demo(Locker * locker,
 		char const * section, char const * variable);
+static LockerConfigSection * _test_helper_config_section(Locker * locker,
+		char const * prefix, char const * section);
+static LockerConfigSection * _test_helper_config_section_auth(Locker * locker,
+		char const * section);
+static LockerConfigSection * _test_helper_config_section_demo(Locker * locker,
+		char const * section);
+static char const * _test_helper_config_section_get(Locker * locker,
+		LockerConfigSection const * section, char const * variable);
 static int _test_helper_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value);
 static int _test_helper_error(Locker * locker, char const * message, int ret);
+static void _test_helper_failed(Locker * locker);
+static guint _test_helper_frame_add(Locker * locker, unsigned int fps,
+		LockerDemoFrameFunc func, gpointer data);
+static int _test_helper_frame_age(Locker * locker);
+static void _test_helper_frame_damage(Locker * locker,
+		GdkRectangle const * area);
+static gint64 _test_helper_frame_deadline(Locker * locker);
+static gint64 _test_helper_frame_elapsed(Locker * locker);
+static void _test_helper_frame_remove(Locker * locker, guint id);
 
 /* callbacks */
 static gboolean _test_on_closex(void);
 static void _test_on_apply(gpointer data);
 static void _test_on_cycle(gpointer data);
+static gboolean _test_on_frame(gpointer data);
 static void _test_on_lock(gpointer data);
 static void _test_on_reload(gpointer data);
+static gboolean _test_on_render(gint64 time, gpointer data);
 static void _test_on_start(gpointer data);
 static void _test_on_stop(gpointer data);
 static void _test_on_unlock(gpointer data);
@@ -108,6 +147,7 @@ static int _test(int desktop, int fullscreen, int root, int width, int height,
 	Plugin * dplugin;
 	LockerAuthHelper ahelper;
 	Plugin * aplugin;
+	LockerConfigSection * s;
 #if GTK_CHECK_VERSION(3, 0, 0)
 	GdkRGBA black;
 #else
@@ -130,11 +170,25 @@ static int _test(int desktop, int fullscreen, int root, int width, int height,
 				strerror(errno));
 	}
 	locker->config = _test_config();
+	locker->sections = NULL;
+	locker->start = g_get_monotonic_time();
+	locker->wwindow = NULL;
+	locker->surface = NULL;
+	locker->age = 0;
+	locker->render = 0;
 	/* demo plug-in */
 	dhelper.locker = locker;
 	dhelper.error = _test_helper_error;
 	dhelper.config_get = _test_helper_config_get_demo;
 	dhelper.config_set = _test_helper_config_set;
+	dhelper.config_section = _test_helper_config_section_demo;
+	dhelper.config_section_get = _test_helper_config_section_get;
+	dhelper.frame_add = _test_helper_frame_add;
+	dhelper.frame_remove = _test_helper_frame_remove;
+	dhelper.frame_elapsed = _test_helper_frame_elapsed;
+	dhelper.frame_deadline = _test_helper_frame_deadline;
+	dhelper.frame_damage = _test_helper_frame_damage;
+	dhelper.frame_age = _test_helper_frame_age;
 	if((dplugin = plugin_new(LIBDIR, PACKAGE, "demos", demo)) == NULL)
 	{
 		if(locker->config != NULL)
@@ -163,6 +217,9 @@ static int _test(int desktop, int fullscreen, int root, int width, int height,
 	ahelper.action = _test_helper_action;
 	ahelper.config_get = _test_helper_config_get_auth;
 	ahelper.config_set = _test_helper_config_set;
+	ahelper.config_section = _test_helper_config_section_auth;
+	ahelper.config_section_get = _test_helper_config_section_get;
+	ahelper.failed = _test_helper_failed;
 	if(auth == NULL)
 	{
 		aplugin = NULL;
@@ -272,13 +329,25 @@ static int _test(int desktop, int fullscreen, int root, int width, int height,
 		wwindow = locker->window->window;
 #endif
 	}
-	if(locker->dplugin->add(locker->demo, wwindow) != 0)
+	locker->wwindow = wwindow;
+	if(locker->dplugin->add != NULL
+			&& locker->dplugin->add(locker->demo, wwindow) != 0)
 		ret = error_set_print(PROGNAME_LOCKER_TEST, 1, "%s: %s", demo,
 				"Could not add window");
 	else
 	{
-		locker->dplugin->start(locker->demo);
+		locker->start = g_get_monotonic_time();
+		if(locker->dplugin->start != NULL)
+			locker->dplugin->start(locker->demo);
+		if(locker->dplugin->render != NULL)
+			locker->render = _test_helper_frame_add(locker,
+					TEST_FRAME_RATE, _test_on_render,
+					locker);
 		gtk_main();
+		if(locker->render != 0)
+			_test_helper_frame_remove(locker, locker->render);
+		if(locker->surface != NULL)
+			cairo_surface_destroy(locker->surface);
 		if(locker->aplugin != NULL && locker->aplugin->destroy != NULL)
 			locker->aplugin->destroy(locker->auth);
 		if(locker->window != NULL)
@@ -291,6 +360,12 @@ static int _test(int desktop, int fullscreen, int root, int width, int height,
 	plugin_delete(dplugin);
 	if(locker->config != NULL)
 		config_delete(locker->config);
+	while((s = locker->sections) != NULL)
+	{
+		locker->sections = s->next;
+		string_delete(s->name);
+		object_delete(s);
+	}
 	free(locker->name);
 	object_delete(locker);
 	return ret;
@@ -351,20 +426,33 @@ static int _test_helper_action(Locker * locker, LockerAction action)
 		case LOCKER_ACTION_RELOAD:
 			if(locker->dplugin->reload != NULL)
 				locker->dplugin->reload(locker->demo);
+			/* the frame rendered may not match the configuration */
+			locker->age = 0;
 			if(locker->auth != NULL
 					&& locker->aplugin->action != NULL)
 				locker->aplugin->action(locker->auth,
 						LOCKER_ACTION_RELOAD);
 			break;
 		case LOCKER_ACTION_START:
+			locker->start = g_get_monotonic_time();
 			if(locker->dplugin->start != NULL)
 				locker->dplugin->start(locker->demo);
+			/* render every frame of the demo ourselves */
+			if(locker->dplugin->render != NULL
+					&& locker->render == 0)
+				locker->render = _test_helper_frame_add(locker,
+						TEST_FRAME_RATE,
+						_test_on_render, locker);
 			if(locker->auth != NULL
 					&& locker->aplugin->action != NULL)
 				locker->aplugin->action(locker->auth,
 						LOCKER_ACTION_START);
 			break;
 		case LOCKER_ACTION_STOP:
+			if(locker->render != 0)
+				_test_helper_frame_remove(locker,
+						locker->render);
+			locker->render = 0;
 			if(locker->dplugin->stop != NULL)
 				locker->dplugin->stop(locker->demo);
 			if(locker->auth != NULL
@@ -438,6 +526,56 @@ static char const * _test_helper_config_get_demo(Locker * locker,
 }
 
 
+/* test_helper_config_section */
+static LockerConfigSection * _test_helper_config_section(Locker * locker,
+		char const * prefix, char const * section)
+{
+	LockerConfigSection * s;
+
+	if((s = object_new(sizeof(*s))) == NULL)
+		return NULL;
+	if((s->name = string_new_append(prefix, section, NULL)) == NULL)
+	{
+		object_delete(s);
+		return NULL;
+	}
+	s->next = locker->sections;
+	locker->sections = s;
+	return s;
+}
+
+
+/* test_helper_config_section_auth */
+static LockerConfigSection * _test_helper_config_section_auth(Locker * locker,
+		char const * section)
+{
+	return _test_helper_config_section(locker, "auth::", section);
+}
+
+
+/* test_helper_config_section_demo */
+static LockerConfigSection * _test_helper_config_section_demo(Locker * locker,
+		char const * section)
+{
+	return _test_helper_config_section(locker, "demo::", section);
+}
+
+
+/* test_helper_config_section_get */
+static char const * _test_helper_config_section_get(Locker * locker,
+		LockerConfigSection const * section, char const * variable)
+{
+	if(locker->config == NULL)
+	{
+		error_set_code(1, "%s", "Configuration not available");
+		return NULL;
+	}
+	if(section == NULL)
+		return NULL;
+	return config_get(locker->config, section->name, variable);
+}
+
+
 /* test_helper_config_set */
 static int _test_helper_config_set(Locker * locker, char const * section,
 		char const * variable, char const * value)
@@ -457,6 +595,76 @@ static int _test_helper_error(Locker * locker, char const * message, int ret)
 }
 
 
+/* test_helper_failed */
+static void _test_helper_failed(Locker * locker)
+{
+	(void) locker;
+
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+}
+
+
+/* test_helper_frame_add */
+static guint _test_helper_frame_add(Locker * locker, unsigned int fps,
+		LockerDemoFrameFunc func, gpointer data)
+{
+	TestFrame * frame;
+	(void) locker;
+
+	/* there is no frame clock, use a timer instead */
+	if((frame = malloc(sizeof(*frame))) == NULL)
+		return 0;
+	frame->func = func;
+	frame->data = data;
+	return g_timeout_add_full(G_PRIORITY_DEFAULT,
+			1000 / ((fps != 0) ? fps : TEST_FRAME_RATE),
+			_test_on_frame, frame, free);
+}
+
+
+/* test_helper_frame_age */
+static int _test_helper_frame_age(Locker * locker)
+{
+	return locker->age;
+}
+
+
+/* test_helper_frame_damage */
+static void _test_helper_frame_damage(Locker * locker,
+		GdkRectangle const * area)
+{
+	(void) locker;
+	(void) area;
+
+	/* always present the whole frame */
+}
+
+
+/* test_helper_frame_deadline */
+static gint64 _test_helper_frame_deadline(Locker * locker)
+{
+	(void) locker;
+
+	return g_get_monotonic_time() + G_USEC_PER_SEC / TEST_FRAME_RATE;
+}
+
+
+/* test_helper_frame_elapsed */
+static gint64 _test_helper_frame_elapsed(Locker * locker)
+{
+	return g_get_monotonic_time() - locker->start;
+}
+
+
+/* test_helper_frame_remove */
+static void _test_helper_frame_remove(Locker * locker, guint id)
+{
+	(void) locker;
+
+	g_source_remove(id);
+}
+
+
 /* callbacks */
 /* test_on_apply */
 static void _test_on_apply(gpointer data)
@@ -500,6 +708,15 @@ static void _test_on_cycle(gpointer data)
 }
 
 
+/* test_on_frame */
+static gboolean _test_on_frame(gpointer data)
+{
+	TestFrame * frame = data;
+
+	return frame->func(g_get_monotonic_time(), frame->data);
+}
+
+
 /* test_on_lock */
 static void _test_on_lock(gpointer data)
 {
@@ -518,6 +735,60 @@ static void _test_on_reload(gpointer data)
 }
 
 
+/* test_on_render */
+static gboolean _test_on_render(gint64 time, gpointer data)
+{
+	Locker * locker = data;
+	GdkRectangle rect;
+	cairo_t * cairo;
+
+	rect.x = 0;
+	rect.y = 0;
+#if GTK_CHECK_VERSION(3, 0, 0)
+	rect.width = gdk_window_get_width(locker->wwindow);
+	rect.height = gdk_window_get_height(locker->wwindow);
+#else
+	gdk_drawable_get_size(locker->wwindow, &rect.width, &rect.height);
+#endif
+	if(rect.width <= 0 || rect.height <= 0)
+		return TRUE;
+	/* (re)allocate the buffer if necessary */
+	if(locker->surface != NULL
+			&& (cairo_image_surface_get_width(locker->surface)
+				!= rect.width
+				|| cairo_image_surface_get_height(
+					locker->surface) != rect.height))
+	{
+		cairo_surface_destroy(locker->surface);
+		locker->surface = NULL;
+	}
+	if(locker->surface == NULL)
+	{
+		locker->surface = cairo_image_surface_create(
+				CAIRO_FORMAT_ARGB32, rect.width, rect.height);
+		locker->age = 0;
+	}
+	cairo_surface_flush(locker->surface);
+	if(locker->dplugin->render(locker->demo,
+				cairo_image_surface_get_data(locker->surface),
+				cairo_image_surface_get_stride(locker->surface),
+				&rect, &rect, time - locker->start) < 0)
+	{
+		locker->age = 0;
+		return TRUE;
+	}
+	locker->age = 1;
+	cairo_surface_mark_dirty(locker->surface);
+	/* present the frame */
+	cairo = gdk_cairo_create(locker->wwindow);
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface(cairo, locker->surface, 0.0, 0.0);
+	cairo_paint(cairo);
+	cairo_destroy(cairo);
+	return TRUE;
+}
+
+
 /* test_on_start */
 static void _test_on_start(gpointer data)
 {